@@ -1,11 +1,51 @@
 #include <bch.h>
+#include <cpu.h>
+#include <gfsimd.h>
+#include <pool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
 
-#define POLY 0x13
+/* Field elements live in bytes up to GF(2^8), in 16-bit words above. */
+#if BCH_M <= 8
+typedef unsigned char gf_elem_t;
+typedef gf8_tab_t gf_tab_t;
+#define _gf_tab_init   gf8_tab_init
+#define _gf_mul_region gf8_mul_region
+#else
+typedef unsigned short gf_elem_t;
+typedef gf16_tab_t gf_tab_t;
+#define _gf_tab_init   gf16_tab_init
+#define _gf_mul_region gf16_mul_region
+#endif
+
+/* Codewords whose syndromes are evaluated side by side in the wide path. */
+#define BCH_LANES 64
+
+/* Blocks per pool task, a multiple of BCH_LANES (and so of 8: tasks never share a byte). */
+#define BCH_TASK_BLOCKS (BCH_LANES * 128)
+
+_Static_assert(BCH_T >= 1 && 2 * BCH_T + 1 <= BCH_N && BCH_K >= 1 && BCH_K < BCH_N, "BCH_T / BCH_K don't fit BCH_M");
 
 static int _alpha_to[1 << BCH_M];
 static int _index_of[1 << BCH_M];
 static int _g[BCH_N - BCH_K + 1];
-static int _initialized = 0;
+static _Atomic int _initialized = 0;
+
+/* _chien_pow[k][j] = a^(-j(k+1)), Chien search multiplies whole rows by Lambda_(k+1). */
+static gf_elem_t _chien_pow[BCH_T][BCH_N];
+
+/* Syndromes S1..S2t packed BCH_M bits apiece, fits one word for small codes. */
+#define BCH_SYND_PACKED (2 * BCH_T * BCH_M <= 64)
+#define BCH_CHUNKS      ((BCH_N + 7) / 8)
+
+#if BCH_SYND_PACKED
+static unsigned long long _synd_tab[BCH_CHUNKS][256];
+#else
+/* Multiply-by-a^(2i+1) tables for the odd syndromes, even ones are squares. */
+static gf_tab_t _synd_mul[BCH_T];
+#endif
 
 static int _generate_gf() {
     int mask = 1;
@@ -13,7 +53,7 @@ static int _generate_gf() {
     for (int i = 0; i < BCH_M; i++) {
         _alpha_to[i] = mask;
         _index_of[_alpha_to[i]] = i;
-        if ((POLY >> (BCH_M - 1 - i)) & 1)
+        if ((BCH_POLY >> i) & 1)
             _alpha_to[BCH_M] ^= mask;
         mask <<= 1;
     }
@@ -32,40 +72,113 @@ static int _generate_gf() {
     return 1;
 }
 
+/*
+Binary generator: product of (x + a^r) over the cyclotomic cosets of a^1..a^2t,
+so every coefficient lands in GF(2) and the LFSR below emits real codewords.
+Roots past BCH_N - BCH_K (a BCH_K too large for BCH_T) are only counted, _g holds that many.
+
+Return generator degree.
+*/
 static int _gen_poly() {
-    int b[2 * BCH_T];
+    int used[BCH_N] = { 0 };
+    int deg = 0;
     _g[0] = 1;
     
-    for (int i = 0; i < 2 * BCH_T; i++) {
-        b[i] = _alpha_to[i + 1];
-        _g[i + 1] = 1;
-        
-        for (int j = i; j > 0; j--) {
-            if (_g[j]) 
-                _g[j] = _g[j - 1] ^ _alpha_to[(_index_of[_g[j]] + _index_of[b[i]]) % ((1 << BCH_M) - 1)];
-            else 
-                _g[j] = _g[j - 1];
+    for (int i = 1; i <= 2 * BCH_T; i++) {
+        for (int r = i % BCH_N; !used[r]; r = (r * 2) % BCH_N) {
+            used[r] = 1;
+            if (deg >= BCH_N - BCH_K) {
+                deg++;
+                continue;
+            }
+
+            _g[deg + 1] = _g[deg];
+            for (int j = deg; j > 0; j--) {
+                if (_g[j]) 
+                    _g[j] = _g[j - 1] ^ _alpha_to[(_index_of[_g[j]] + r) % BCH_N];
+                else 
+                    _g[j] = _g[j - 1];
+            }
+            _g[0] = _alpha_to[(_index_of[_g[0]] + r) % BCH_N];
+            deg++;
+        }
+    }
+
+    return deg;
+}
+
+#if BCH_SYND_PACKED
+/*
+Syndromes are linear in the codeword bits, so the packed syndrome
+contribution of every 8-bit chunk can be tabulated once and the whole
+syndrome vector becomes a handful of lookups XORed together.
+*/
+static int _gen_synd_tab() {
+    for (int q = 0; q < BCH_CHUNKS; q++) {
+        for (int v = 0; v < 256; v++) {
+            unsigned long long packed = 0;
+            for (int r = 0; r < 8 && q * 8 + r < BCH_N; r++) {
+                if (!((v >> (7 - r)) & 1)) continue;
+                for (int i = 0; i < 2 * BCH_T; i++) {
+                    packed ^= (unsigned long long)_alpha_to[(i + 1) * (q * 8 + r) % ((1 << BCH_M) - 1)] << (i * BCH_M);
+                }
+            }
+
+            _synd_tab[q][v] = packed;
         }
-        _g[0] = _alpha_to[(_index_of[b[i]] + _index_of[_g[0]]) % ((1 << BCH_M) - 1)];
     }
 
     return 1;
 }
+#else
+static int _gen_synd_mul() {
+    for (int i = 0; i < BCH_T; i++) {
+        _gf_tab_init(&_synd_mul[i], _alpha_to[(2 * i + 1) % BCH_N], _alpha_to, _index_of, BCH_N);
+    }
 
-int bch_init() {
-    if (!_initialized) {
-        _generate_gf();
-        _gen_poly();
-        _initialized = 1;
-        return 1;
+    return 1;
+}
+#endif
+
+static int _gen_chien_pow() {
+    for (int k = 0; k < BCH_T; k++) {
+        for (int j = 0; j < BCH_N; j++) {
+            _chien_pow[k][j] = (gf_elem_t)_alpha_to[(BCH_N - (long)j * (k + 1) % BCH_N) % BCH_N];
+        }
     }
-    return 0;
+
+    return 1;
+}
+
+static void _setup() {
+    _generate_gf();
+    int deg = _gen_poly();
+    if (deg != BCH_N - BCH_K) {
+        fprintf(stderr, "[bch] BCH_K=%d doesn't match BCH_M=%d, BCH_T=%d: the generator has degree %d, BCH_K must be %d\n",
+                BCH_K, BCH_M, BCH_T, deg, BCH_N - deg);
+        abort();
+    }
+
+#if BCH_SYND_PACKED
+    _gen_synd_tab();
+#else
+    _gen_synd_mul();
+#endif
+    _gen_chien_pow();
+    _initialized = 1;
+}
+
+int bch_init() {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    if (_initialized) return 0;
+    pthread_once(&once, _setup);
+    return 1;
 }
 
 static int _encode_bits(const unsigned char* data_bits, unsigned char* out_bits) {
     int reg[BCH_N - BCH_K] = {0};
     
-    for (int i = 0; i < BCH_K; i++) {
+    for (int i = BCH_K - 1; i >= 0; i--) {
         int feedback = data_bits[i] ^ reg[BCH_N - BCH_K - 1];
         for (int j = BCH_N - BCH_K - 1; j > 0; j--) {
             reg[j] = reg[j - 1] ^ (feedback ? _g[j] : 0);
@@ -94,12 +207,30 @@ static inline void _set_bit(unsigned char* data, unsigned long bit_index, int va
         data[byte_index] &= ~(1 << bit_in_byte);
 }
 
-unsigned long encode_bch(const unsigned char* input, unsigned long input_len, unsigned char* output) {
-    str_memset(output, 0, (input_len * 8 / BCH_K * BCH_N + 7) / 8);
-    unsigned long in_bits = input_len * 8;
-    unsigned long out_bit = 0;
-    
-    for (unsigned long pos = 0; pos < in_bits; pos += BCH_K) {
+/*
+MSB-first multi-bit helpers (count <= 8), touching only bytes that hold requested bits.
+*/
+static inline int _get_bits(const unsigned char* data, unsigned long bit_index, int count) {
+    unsigned long byte_index = bit_index / 8;
+    int shift = bit_index % 8;
+    int val = (data[byte_index] << shift) & 0xFF;
+    if (shift + count > 8) val |= data[byte_index + 1] >> (8 - shift);
+    return val >> (8 - count);
+}
+
+static inline void _set_bits(unsigned char* data, unsigned long bit_index, int count, int value) {
+    unsigned long byte_index = bit_index / 8;
+    int shift = bit_index % 8;
+    int wide = (value & ((1 << count) - 1)) << (16 - shift - count);
+    int mask = ((1 << count) - 1) << (16 - shift - count);
+    data[byte_index] = (data[byte_index] & ~(mask >> 8)) | (wide >> 8);
+    if (shift + count > 8) 
+        data[byte_index + 1] = (data[byte_index + 1] & ~(mask & 0xFF)) | (wide & 0xFF);
+}
+
+static void _encode_range(const unsigned char* input, unsigned long in_bits, unsigned char* output, long b, long end) {
+    for (; b < end; b++) {
+        unsigned long pos = (unsigned long)b * BCH_K;
         unsigned char data_bits[BCH_K] = { 0 };
         unsigned char codeword[BCH_N] = { 0 };
         
@@ -109,76 +240,314 @@ unsigned long encode_bch(const unsigned char* input, unsigned long input_len, un
         _encode_bits(data_bits, codeword);
         
         for (int i = 0; i < BCH_N; i++) 
-            _set_bit(output, out_bit + i, codeword[i]);
-        
-        out_bit += BCH_N;
+            _set_bit(output, (unsigned long)b * BCH_N + i, codeword[i]);
     }
+}
+
+typedef struct {
+    const unsigned char* input;
+    unsigned long        in_bits;
+    unsigned char*       output;
+} bch_job_t;
 
-    return (out_bit + 7) / 8;
+HAMM_KERNEL static void _encode_task(void* ctx, long begin, long end) {
+    bch_job_t* job = (bch_job_t*)ctx;
+    _encode_range(job->input, job->in_bits, job->output, begin, end);
 }
 
-static int _decode_bits(unsigned char* codeword_bits) {
-    int synd[2 * BCH_T];
+HAMM_KERNEL unsigned long encode_bch(const unsigned char* input, unsigned long input_len, unsigned char* output) {
+    unsigned long in_bits = input_len * 8;
+    long blocks = (in_bits + BCH_K - 1) / BCH_K;
+    str_memset(output, 0, ((unsigned long)blocks * BCH_N + 7) / 8);
+
+    bch_job_t job = { .input = input, .in_bits = in_bits, .output = output };
+    pool_parallel_for(blocks, BCH_TASK_BLOCKS, BCH_LANES, _encode_task, &job);
+    return ((unsigned long)blocks * BCH_N + 7) / 8;
+}
+
+static inline int _gf_mul(int a, int b) {
+    if (!a || !b) return 0;
+    return _alpha_to[(_index_of[a] + _index_of[b]) % BCH_N];
+}
+
+static inline int _gf_div(int a, int b) {
+    if (!a) return 0;
+    return _alpha_to[(_index_of[a] - _index_of[b] + BCH_N) % BCH_N];
+}
+
+/*
+Berlekamp-Massey over S1..S2t, then Chien search for the roots a^(-j) of the
+error locator. Evaluation of Lambda at every position is done row-wise with
+the region multiply, so the whole search is t vector passes over N elements.
+Blocks with more than t errors (locator degree above t or fewer roots than
+its degree) are left as they are.
+
+Params:
+- codeword_bits - Codeword, one bit per byte.
+- synd - S1..S2t.
+
+Return corrected errors count or -1.
+*/
+static int _decode_bits(unsigned char* codeword_bits, const int* synd) {
+    int lambda[2 * BCH_T + 1] = { 1 };
+    int prev[2 * BCH_T + 1] = { 1 };
+    int saved[2 * BCH_T + 1];
+    int len = 0, shift = 1, prev_d = 1;
+
+    for (int n = 0; n < 2 * BCH_T; n++) {
+        int d = synd[n];
+        for (int i = 1; i <= len; i++) 
+            d ^= _gf_mul(lambda[i], synd[n - i]);
+        if (!d) {
+            shift++;
+            continue;
+        }
+
+        int coef = _gf_div(d, prev_d);
+        int grow = 2 * len <= n;
+        if (grow) str_memcpy(saved, lambda, sizeof(lambda));
+        for (int i = 0; i + shift <= 2 * BCH_T; i++) 
+            lambda[i + shift] ^= _gf_mul(coef, prev[i]);
+
+        if (grow) {
+            len = n + 1 - len;
+            str_memcpy(prev, saved, sizeof(prev));
+            prev_d = d;
+            shift = 1;
+        }
+        else shift++;
+    }
+
+    if (!len) return 0;
+    if (len > BCH_T) return -1;
+
+    gf_elem_t acc[BCH_N];
+    for (int j = 0; j < BCH_N; j++) acc[j] = 1;
+    for (int k = 1; k <= len; k++) {
+        if (!lambda[k]) continue;
+        gf_tab_t tab;
+        _gf_tab_init(&tab, lambda[k], _alpha_to, _index_of, BCH_N);
+        _gf_mul_region(acc, _chien_pow[k - 1], acc, BCH_N, &tab);
+    }
+
     int error_loc[BCH_T];
     int num_errors = 0;
+    for (int j = 0; j < BCH_N; j++) {
+        if (acc[j]) continue;
+        if (num_errors == len) return -1;
+        error_loc[num_errors++] = j;
+    }
 
-    // Вычисление синдромов
-    for (int i = 0; i < 2 * BCH_T; i++) {
-        synd[i] = 0;
-        for (int j = 0; j < BCH_N; j++) {
-            if (codeword_bits[j]) {
-                synd[i] ^= _alpha_to[(i + 1) * j % ((1 << BCH_M) - 1)];
-            }
-        }
+    if (num_errors != len) return -1;
+    for (int i = 0; i < num_errors; i++) {
+        codeword_bits[error_loc[i]] ^= 1;
     }
 
-    // Проверка на отсутствие ошибок
-    int has_errors = 0;
-    for (int i = 0; i < 2 * BCH_T; i++) {
-        if (synd[i] != 0) {
-            has_errors = 1;
-            break;
+    return num_errors;
+}
+
+static inline void _copy_data(const unsigned char* input, unsigned long pos, unsigned char* output, unsigned long out_bit) {
+    for (int i = 0; i < BCH_K; i += 8) {
+        int count = BCH_K - i < 8 ? BCH_K - i : 8;
+        _set_bits(output, out_bit + i, count, _get_bits(input, pos + BCH_N - BCH_K + i, count));
+    }
+}
+
+static void _correct_block(const unsigned char* input, unsigned long pos, unsigned char* output, unsigned long out_bit, const int* synd) {
+    unsigned char codeword[BCH_N] = { 0 };
+    
+    for (int i = 0; i < BCH_N; i++) 
+        codeword[i] = _get_bit(input, pos + i);
+    
+    _decode_bits(codeword, synd);
+    
+    for (int i = 0; i < BCH_K; i++) 
+        _set_bit(output, out_bit + i, codeword[BCH_N - BCH_K + i]);
+}
+
+#if !BCH_SYND_PACKED
+/*
+Syndromes of up to BCH_LANES consecutive codewords at once. Each odd syndrome
+is a Horner chain acc = acc * a^i + c_j over the codeword positions, and every
+step of it is one region multiply across all lanes.
+*/
+static int _lane_syndromes(const unsigned char* input, unsigned long pos, int lanes, int synd[][2 * BCH_T]) {
+    gf_elem_t acc[BCH_T][BCH_LANES] = { 0 };
+    gf_elem_t col[BCH_LANES];
+
+    for (int j = BCH_N - 1; j >= 0; j--) {
+        for (int l = 0; l < lanes; l++) 
+            col[l] = _get_bit(input, pos + (unsigned long)l * BCH_N + j);
+        for (int i = 0; i < BCH_T; i++) 
+            _gf_mul_region(acc[i], acc[i], col, lanes, &_synd_mul[i]);
+    }
+
+    int any = 0;
+    for (int l = 0; l < lanes; l++) {
+        for (int i = 0; i < BCH_T; i++) {
+            synd[l][2 * i] = acc[i][l];
+            any |= acc[i][l];
         }
+
+        for (int i = 1; i <= BCH_T; i++) 
+            synd[l][2 * i - 1] = _gf_mul(synd[l][i - 1], synd[l][i - 1]);
     }
-    if (!has_errors) return 0;
 
-    // Упрощенный алгоритм поиска ошибок (только для 1-2 ошибок)
-    for (int i = 0; i < BCH_N && num_errors < BCH_T; i++) {
-        int sum = 0;
-        for (int j = 0; j < 2 * BCH_T; j++) {
-            sum ^= _alpha_to[(synd[j] + j * i) % ((1 << BCH_M) - 1)];
+    return any;
+}
+#endif
+
+static void _decode_range(const unsigned char* input, unsigned char* output, long b, long end) {
+#if BCH_SYND_PACKED
+    for (; b < end; b++) {
+        unsigned long pos = (unsigned long)b * BCH_N;
+        unsigned long out_bit = (unsigned long)b * BCH_K;
+        // Быстрый путь: нулевой синдром => данные копируются без распаковки по битам
+        unsigned long long packed = 0;
+        for (int q = 0; q < BCH_CHUNKS; q++) {
+            int count = BCH_N - q * 8 < 8 ? BCH_N - q * 8 : 8;
+            packed ^= _synd_tab[q][_get_bits(input, pos + q * 8, count) << (8 - count)];
         }
-        if (sum == 0) {
-            error_loc[num_errors++] = i;
+
+        if (!packed) _copy_data(input, pos, output, out_bit);
+        else {
+            int synd[2 * BCH_T];
+            for (int i = 0; i < 2 * BCH_T; i++) 
+                synd[i] = (packed >> (i * BCH_M)) & BCH_N;
+            _correct_block(input, pos, output, out_bit, synd);
         }
     }
+#else
+    for (; b < end; b += BCH_LANES) {
+        unsigned long pos = (unsigned long)b * BCH_N;
+        int lanes = end - b < BCH_LANES ? (int)(end - b) : BCH_LANES;
+        int synd[BCH_LANES][2 * BCH_T];
+        int dirty = _lane_syndromes(input, pos, lanes, synd);
 
-    // Исправление ошибок
-    for (int i = 0; i < num_errors; i++) {
-        codeword_bits[error_loc[i]] ^= 1;
+        for (int l = 0; l < lanes; l++) {
+            unsigned long block = pos + (unsigned long)l * BCH_N;
+            unsigned long out_bit = (unsigned long)(b + l) * BCH_K;
+            int clean = 1;
+            for (int i = 0; dirty && i < 2 * BCH_T; i++) 
+                if (synd[l][i]) clean = 0;
+
+            if (clean) _copy_data(input, block, output, out_bit);
+            else _correct_block(input, block, output, out_bit, synd[l]);
+        }
     }
+#endif
+}
 
-    return num_errors;
+HAMM_KERNEL static void _decode_task(void* ctx, long begin, long end) {
+    bch_job_t* job = (bch_job_t*)ctx;
+    _decode_range(job->input, job->output, begin, end);
 }
 
-unsigned long decode_bch(const unsigned char* input, unsigned long input_len, unsigned char* output) {
+HAMM_KERNEL unsigned long decode_bch(const unsigned char* input, unsigned long input_len, unsigned char* output) {
     str_memset(output, 0, (input_len * 8 / BCH_N * BCH_K + 7) / 8);
-    unsigned long in_bits = input_len * 8;
-    unsigned long out_bit = 0;
+    long blocks = input_len * 8 / BCH_N;
 
-    for (unsigned long pos = 0; pos + BCH_N <= in_bits; pos += BCH_N) {
-        unsigned char codeword[BCH_N] = { 0 };
-        
-        for (int i = 0; i < BCH_N; i++) 
-            codeword[i] = _get_bit(input, pos + i);
-        
-        _decode_bits(codeword);
-        
-        for (int i = 0; i < BCH_K; i++) 
-            _set_bit(output, out_bit + i, codeword[BCH_N - BCH_K + i]);
-        
-        out_bit += BCH_K;
+    bch_job_t job = { .input = input, .in_bits = input_len * 8, .output = output };
+    pool_parallel_for(blocks, BCH_TASK_BLOCKS, BCH_LANES, _decode_task, &job);
+    return ((unsigned long)blocks * BCH_K + 7) / 8;
+}
+
+typedef struct {
+    const unsigned char* input;
+    const unsigned char* reliability;
+    unsigned char*       output;
+    int                  p;
+    atomic_long          corrected;
+} bch_soft_job_t;
+
+/* S1..S2t of a codeword held one bit per byte. */
+static int _bit_syndromes(const unsigned char* codeword_bits, int* synd) {
+    for (int i = 0; i < 2 * BCH_T; i++) synd[i] = 0;
+    for (int j = 0; j < BCH_N; j++) {
+        if (!codeword_bits[j]) continue;
+        for (int i = 0; i < 2 * BCH_T; i++) synd[i] ^= _alpha_to[(i + 1) * j % BCH_N];
+    }
+
+    int any = 0;
+    for (int i = 0; i < 2 * BCH_T; i++) any |= synd[i];
+    return any != 0;
+}
+
+/*
+Syndromes are linear, so a test pattern only XORs the syndrome contributions of its
+positions into the received ones before Berlekamp-Massey and Chien run on the candidate.
+Return bits changed, the block is left as received when no candidate decodes.
+*/
+static int _chase_block(const unsigned char* input, const unsigned char* rel, unsigned long pos, int p, unsigned char* best) {
+    unsigned char hard[BCH_N];
+    unsigned char candidate[BCH_N];
+    int synd[2 * BCH_T];
+    for (int j = 0; j < BCH_N; j++) best[j] = hard[j] = _get_bit(input, pos + j);
+    if (!_bit_syndromes(hard, synd)) return 0;
+
+    int lrp[BCH_CHASE_MAX_P];
+    int found = 0;
+    for (int j = 0; p && j < BCH_N; j++) {
+        if (found == p && rel[j] >= rel[lrp[p - 1]]) continue;
+        int i = found < p ? found++ : p - 1;
+        for (; i > 0 && rel[lrp[i - 1]] > rel[j]; i--) lrp[i] = lrp[i - 1];
+        lrp[i] = j;
+    }
+
+    unsigned long best_metric = ~0UL;
+    int best_changed = 0;
+    for (long pattern = 0; pattern < 1L << found; pattern++) {
+        int test[2 * BCH_T];
+        str_memcpy(candidate, hard, BCH_N);
+        str_memcpy(test, synd, sizeof(test));
+        for (int k = 0; k < found; k++) {
+            if (!((pattern >> k) & 1)) continue;
+            candidate[lrp[k]] ^= 1;
+            for (int i = 0; i < 2 * BCH_T; i++) test[i] ^= _alpha_to[(i + 1) * lrp[k] % BCH_N];
+        }
+
+        if (_decode_bits(candidate, test) < 0) continue;
+        unsigned long metric = 0;
+        int changed = 0;
+        for (int j = 0; j < BCH_N; j++) {
+            if (candidate[j] == hard[j]) continue;
+            metric += rel[j];
+            changed++;
+        }
+
+        if (metric < best_metric) {
+            best_metric = metric;
+            best_changed = changed;
+            str_memcpy(best, candidate, BCH_N);
+        }
+    }
+
+    return best_changed;
+}
+
+HAMM_KERNEL static void _soft_task(void* ctx, long begin, long end) {
+    bch_soft_job_t* job = (bch_soft_job_t*)ctx;
+    unsigned char codeword[BCH_N];
+    long corrected = 0;
+    for (long b = begin; b < end; b++) {
+        unsigned long pos = (unsigned long)b * BCH_N;
+        corrected += _chase_block(job->input, job->reliability + pos, pos, job->p, codeword);
+        for (int i = 0; i < BCH_K; i++) _set_bit(job->output, (unsigned long)b * BCH_K + i, codeword[BCH_N - BCH_K + i]);
     }
 
-    return (out_bit + 7) / 8;
-}
\ No newline at end of file
+    if (corrected) atomic_fetch_add(&job->corrected, corrected);
+}
+
+HAMM_KERNEL unsigned long decode_bch_soft(const unsigned char* input, const unsigned char* reliability, unsigned long input_len, unsigned char* output, int p, long* corrected) {
+    if (corrected) *corrected = 0;
+    p = p < 0 ? 0 : p > BCH_CHASE_MAX_P ? BCH_CHASE_MAX_P : p;
+    bch_init();
+    str_memset(output, 0, (input_len * 8 / BCH_N * BCH_K + 7) / 8);
+    long blocks = input_len * 8 / BCH_N;
+
+    bch_soft_job_t job = { .input = input, .reliability = reliability, .output = output, .p = p };
+    atomic_init(&job.corrected, 0);
+    pool_parallel_for(blocks, BCH_LANES, BCH_LANES, _soft_task, &job);
+    if (corrected) *corrected = atomic_load(&job.corrected);
+    return ((unsigned long)blocks * BCH_K + 7) / 8;
+}
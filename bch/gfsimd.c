@@ -0,0 +1,224 @@
+#include <gfsimd.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    #include <immintrin.h>
+    #define GF_X86 1
+#else
+    #define GF_X86 0
+#endif
+
+#define GF_PORTABLE 0
+#define GF_SSSE3    1
+#define GF_AVX2     2
+
+/* Nibbles above the field width never occur, their table entries stay zero. */
+static inline int _mul(int a, int b, const int* alpha_to, const int* index_of, int order) {
+    if (!a || !b || a > order) return 0;
+    return alpha_to[(index_of[a] + index_of[b]) % order];
+}
+
+int gf8_tab_init(gf8_tab_t* t, int c, const int* alpha_to, const int* index_of, int order) {
+    for (int v = 0; v < 16; v++) {
+        t->lo[v] = (unsigned char)_mul(v, c, alpha_to, index_of, order);
+        t->hi[v] = (unsigned char)_mul(v << 4, c, alpha_to, index_of, order);
+    }
+
+    return 1;
+}
+
+int gf16_tab_init(gf16_tab_t* t, int c, const int* alpha_to, const int* index_of, int order) {
+    for (int n = 0; n < 4; n++) {
+        for (int v = 0; v < 16; v++) {
+            int p = _mul(v << (4 * n), c, alpha_to, index_of, order);
+            t->lo[n][v] = (unsigned char)(p & 0xFF);
+            t->hi[n][v] = (unsigned char)(p >> 8);
+        }
+    }
+
+    return 1;
+}
+
+static int _level() {
+    static _Atomic int level = -1;
+    if (level < 0) {
+#if GF_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) level = GF_AVX2;
+        else if (__builtin_cpu_supports("ssse3")) level = GF_SSSE3;
+        else level = GF_PORTABLE;
+#else
+        level = GF_PORTABLE;
+#endif
+    }
+
+    return level;
+}
+
+static void _gf8_portable(unsigned char* dst, const unsigned char* src, const unsigned char* add, long len, const gf8_tab_t* t) {
+    for (long i = 0; i < len; i++) {
+        unsigned char r = t->lo[src[i] & 0x0F] ^ t->hi[src[i] >> 4];
+        dst[i] = add ? r ^ add[i] : r;
+    }
+}
+
+static void _gf16_portable(unsigned short* dst, const unsigned short* src, const unsigned short* add, long len, const gf16_tab_t* t) {
+    for (long i = 0; i < len; i++) {
+        unsigned short r = 0;
+        for (int n = 0; n < 4; n++) {
+            int v = (src[i] >> (4 * n)) & 0x0F;
+            r ^= (unsigned short)(t->lo[n][v] | (t->hi[n][v] << 8));
+        }
+
+        dst[i] = add ? r ^ add[i] : r;
+    }
+}
+
+#if GF_X86
+__attribute__((target("ssse3")))
+static void _gf8_ssse3(unsigned char* dst, const unsigned char* src, const unsigned char* add, long len, const gf8_tab_t* t) {
+    const __m128i lo = _mm_loadu_si128((const __m128i*)t->lo);
+    const __m128i hi = _mm_loadu_si128((const __m128i*)t->hi);
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i r = _mm_xor_si128(
+            _mm_shuffle_epi8(lo, _mm_and_si128(v, mask)),
+            _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(v, 4), mask))
+        );
+        if (add) r = _mm_xor_si128(r, _mm_loadu_si128((const __m128i*)(add + i)));
+        _mm_storeu_si128((__m128i*)(dst + i), r);
+    }
+
+    _gf8_portable(dst + i, src + i, add ? add + i : 0, len - i, t);
+}
+
+__attribute__((target("avx2")))
+static void _gf8_avx2(unsigned char* dst, const unsigned char* src, const unsigned char* add, long len, const gf8_tab_t* t) {
+    const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)t->lo));
+    const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)t->hi));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    long i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i r = _mm256_xor_si256(
+            _mm256_shuffle_epi8(lo, _mm256_and_si256(v, mask)),
+            _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(v, 4), mask))
+        );
+        if (add) r = _mm256_xor_si256(r, _mm256_loadu_si256((const __m256i*)(add + i)));
+        _mm256_storeu_si256((__m256i*)(dst + i), r);
+    }
+
+    _gf8_ssse3(dst + i, src + i, add ? add + i : 0, len - i, t);
+}
+
+/*
+16 elements per step: split into a vector of low bytes and a vector of
+high bytes, run the eight nibble shuffles, interleave back.
+*/
+__attribute__((target("ssse3")))
+static void _gf16_ssse3(unsigned short* dst, const unsigned short* src, const unsigned short* add, long len, const gf16_tab_t* t) {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i low8 = _mm_set1_epi16(0x00FF);
+    __m128i tlo[4], thi[4];
+    for (int n = 0; n < 4; n++) {
+        tlo[n] = _mm_loadu_si128((const __m128i*)t->lo[n]);
+        thi[n] = _mm_loadu_si128((const __m128i*)t->hi[n]);
+    }
+
+    long i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(src + i + 8));
+        __m128i lb = _mm_packus_epi16(_mm_and_si128(a, low8), _mm_and_si128(b, low8));
+        __m128i hb = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+        __m128i nib[4] = {
+            _mm_and_si128(lb, mask), _mm_and_si128(_mm_srli_epi64(lb, 4), mask),
+            _mm_and_si128(hb, mask), _mm_and_si128(_mm_srli_epi64(hb, 4), mask)
+        };
+
+        __m128i rl = _mm_setzero_si128(), rh = _mm_setzero_si128();
+        for (int n = 0; n < 4; n++) {
+            rl = _mm_xor_si128(rl, _mm_shuffle_epi8(tlo[n], nib[n]));
+            rh = _mm_xor_si128(rh, _mm_shuffle_epi8(thi[n], nib[n]));
+        }
+
+        __m128i r0 = _mm_unpacklo_epi8(rl, rh);
+        __m128i r1 = _mm_unpackhi_epi8(rl, rh);
+        if (add) {
+            r0 = _mm_xor_si128(r0, _mm_loadu_si128((const __m128i*)(add + i)));
+            r1 = _mm_xor_si128(r1, _mm_loadu_si128((const __m128i*)(add + i + 8)));
+        }
+
+        _mm_storeu_si128((__m128i*)(dst + i), r0);
+        _mm_storeu_si128((__m128i*)(dst + i + 8), r1);
+    }
+
+    _gf16_portable(dst + i, src + i, add ? add + i : 0, len - i, t);
+}
+
+/*
+Same as SSSE3 with 32 elements per step. Pack/unpack work inside 128-bit
+lanes, which is fine since the result is unpacked with the same lane order.
+*/
+__attribute__((target("avx2")))
+static void _gf16_avx2(unsigned short* dst, const unsigned short* src, const unsigned short* add, long len, const gf16_tab_t* t) {
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    const __m256i low8 = _mm256_set1_epi16(0x00FF);
+    __m256i tlo[4], thi[4];
+    for (int n = 0; n < 4; n++) {
+        tlo[n] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)t->lo[n]));
+        thi[n] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)t->hi[n]));
+    }
+
+    long i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(src + i + 16));
+        __m256i lb = _mm256_packus_epi16(_mm256_and_si256(a, low8), _mm256_and_si256(b, low8));
+        __m256i hb = _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+        __m256i nib[4] = {
+            _mm256_and_si256(lb, mask), _mm256_and_si256(_mm256_srli_epi64(lb, 4), mask),
+            _mm256_and_si256(hb, mask), _mm256_and_si256(_mm256_srli_epi64(hb, 4), mask)
+        };
+
+        __m256i rl = _mm256_setzero_si256(), rh = _mm256_setzero_si256();
+        for (int n = 0; n < 4; n++) {
+            rl = _mm256_xor_si256(rl, _mm256_shuffle_epi8(tlo[n], nib[n]));
+            rh = _mm256_xor_si256(rh, _mm256_shuffle_epi8(thi[n], nib[n]));
+        }
+
+        __m256i r0 = _mm256_unpacklo_epi8(rl, rh);
+        __m256i r1 = _mm256_unpackhi_epi8(rl, rh);
+        if (add) {
+            r0 = _mm256_xor_si256(r0, _mm256_loadu_si256((const __m256i*)(add + i)));
+            r1 = _mm256_xor_si256(r1, _mm256_loadu_si256((const __m256i*)(add + i + 16)));
+        }
+
+        _mm256_storeu_si256((__m256i*)(dst + i), r0);
+        _mm256_storeu_si256((__m256i*)(dst + i + 16), r1);
+    }
+
+    _gf16_ssse3(dst + i, src + i, add ? add + i : 0, len - i, t);
+}
+#endif
+
+void gf8_mul_region(unsigned char* dst, const unsigned char* src, const unsigned char* add, long len, const gf8_tab_t* t) {
+#if GF_X86
+    switch (_level()) {
+        case GF_AVX2:  _gf8_avx2(dst, src, add, len, t); return;
+        case GF_SSSE3: _gf8_ssse3(dst, src, add, len, t); return;
+    }
+#endif
+    _gf8_portable(dst, src, add, len, t);
+}
+
+void gf16_mul_region(unsigned short* dst, const unsigned short* src, const unsigned short* add, long len, const gf16_tab_t* t) {
+#if GF_X86
+    switch (_level()) {
+        case GF_AVX2:  _gf16_avx2(dst, src, add, len, t); return;
+        case GF_SSSE3: _gf16_ssse3(dst, src, add, len, t); return;
+    }
+#endif
+    _gf16_portable(dst, src, add, len, t);
+}
@@ -5,45 +5,67 @@
 #include <string>
 #include <cstring>
 #include <cstdlib>
+#include <filesystem>
 #include <BCH.h>
 #include <Utilities.h>
+#include <hamm/hamm.h>
 
 using namespace std;
 
 #define PARITY_BITS_ARG "--pb"
+#define M_ARG           "--m"
+#define T_ARG           "--t"
 #define TARGET_ARG      "--target"
 #define OUTPUT_ARG      "--out"
 
-static int _m = 7;
+static int _m = 15;
+static int _t = 3;
 static const char* _target   = "encoded.bin";
 static const char* _out_path = "decoded.bin";
 
+/*
+--m (or --pb) / --t - Code of files without a header (default 15 / 3, what file2bch used to write)
+--target - Target file for decoding
+--out - Path to save location (will create new file)
+Files with a hamm_header_t (HAMM_FLAG_BCH) are decoded with the m and t it records and cut to the original size.
+*/
 int main(int argc, char* argv[]) {
     if (argc > 1) {
         for (int i = 1; i < argc; i++) {
-            if (!strcmp(argv[i], PARITY_BITS_ARG)) _m = atoi(argv[++i]);
-            else if (!strcmp(argv[i], TARGET_ARG)) _target = argv[++i];
-            else if (!strcmp(argv[i], OUTPUT_ARG)) _out_path = argv[++i];
+            const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+            if ((!strcmp(argv[i], PARITY_BITS_ARG) || !strcmp(argv[i], M_ARG)) && value) _m = atoi(argv[++i]);
+            else if (!strcmp(argv[i], T_ARG) && value) _t = atoi(argv[++i]);
+            else if (!strcmp(argv[i], TARGET_ARG) && value) _target = argv[++i];
+            else if (!strcmp(argv[i], OUTPUT_ARG) && value) _out_path = argv[++i];
             else {
-                cerr << "Unknown argument: " << argv[i] << endl;
+                cerr << "Unknown argument or missing value: " << argv[i] << endl;
                 return EXIT_FAILURE;
             }
         }
     }
 
-    cout << "[bch_decode] _target=" << _target << ", _out_path=" << _out_path << ", _m=" << _m << endl;
-
     ifstream fin(_target, ios::binary);
     if (!fin) {
         cerr << "Cannot open input file: " << _target << endl;
         return EXIT_FAILURE;
     }
 
-    vector<unsigned char> encoded((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
-    fin.close();
+    hamm_header_t header = {};
+    if (fin.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == HAMM_MAGIC && (header.flags & HAMM_FLAG_BCH)) {
+        _m = header.m;
+        _t = header.reserved;
+    }
+    else {
+        header.flags = 0;
+        fin.clear();
+        fin.seekg(0);
+    }
 
-    Coding::BCH bch(15, 7);
-    Coding::bytes decoded = bch.decode(encoded);
+    cout << "[bch_decode] _target=" << _target << ", _out_path=" << _out_path << ", _m=" << _m << ", _t=" << _t << endl;
+    if (_m < 3 || _m > 20 || _t < 1 || 2L * _t + 1 > (1L << _m) - 1 || (1L << _m) - 1 <= (long)Coding::BCH::parity_bits(_m, 2 * _t + 1)) {
+        cerr << "Unsupported code m=" << _m << ", t=" << _t << endl;
+        return EXIT_FAILURE;
+    }
 
     ofstream fout(_out_path, ios::binary);
     if (!fout) {
@@ -51,8 +73,35 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    fout.write(reinterpret_cast<const char*>(decoded.data()), decoded.size());
+    // Streamed in groups of blocks, the file is never held in memory as a whole.
+    // Blocks past t errors are written as received and reported once the whole file is through.
+    Coding::BCH bch(_m, 2 * _t + 1);
+    size_t uncorrectable = 0;
+    try {
+        bch.decode(fin, fout);
+    }
+    catch (const Coding::Uncorrectable& e) {
+        uncorrectable = e.blocks();
+    }
+    fin.close();
     fout.close();
+    if (!fout) {
+        cerr << "Cannot write output file: " << _out_path << endl;
+        return EXIT_FAILURE;
+    }
+
+    // The stream drops trailing zero bytes and keeps the padding of the last block, the header knows better.
+    error_code resize_error;
+    if (header.flags & HAMM_FLAG_BCH) filesystem::resize_file(_out_path, header.size, resize_error);
+    if (resize_error) {
+        cerr << "Cannot resize output file: " << _out_path << endl;
+        return EXIT_FAILURE;
+    }
+
+    if (uncorrectable) {
+        cerr << "[bch_decode] " << uncorrectable << " blocks hold more than t=" << _t << " errors: " << _out_path << endl;
+        return EXIT_FAILURE;
+    }
 
     cout << "File decoded successfully: " << _out_path << endl;
     return EXIT_SUCCESS;
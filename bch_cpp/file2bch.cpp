@@ -5,33 +5,138 @@
 #include <string>
 #include <cstring>
 #include <cstdlib>
+#include <cmath>
+#include <filesystem>
 #include <BCH.h>
 #include <Utilities.h>
+#include <hamm/hamm.h>
+#include <hamm/adapt.h>
 
 using namespace std;
 
 #define PARITY_BITS_ARG "--pb"
+#define M_ARG           "--m"
+#define T_ARG           "--t"
+#define N_ARG           "--n"
+#define K_ARG           "--k"
+#define AUTO_ARG        "--auto"
+#define BER_ARG         "--ber"
+#define TARGET_BER_ARG  "--target-ber"
 #define TARGET_ARG      "--target"
 #define OUTPUT_ARG      "--out"
 
-static int _m = 7;
+#define MIN_M      3
+#define MAX_M      20
+#define AUTO_MAX_M 15 /* 32767-bit blocks */
+
+static int _m = 0;
+static int _t = 0;
+static long _n = 0;
+static long _k = 0;
+static int _auto = 0;
+static double _ber = 1e-4;
+static double _target_ber = 1e-9;
 static const char* _target   = "input.bin";
 static const char* _out_path = "encoded.bin";
 
+/*
+Data bits per block, 0 when the designed distance 2t + 1 does not fit in the block.
+*/
+static long _information_bits(int m, int t) {
+    long n = (1L << m) - 1;
+    if (t < 1 || 2L * t + 1 > n) return 0;
+    return n - (long)Coding::BCH::parity_bits(m, 2 * t + 1);
+}
+
+/*
+Smallest encoded size (padding of the last block included, so small inputs
+land on short blocks) among the codes meeting --target-ber at --ber.
+Ties go to the shorter block. Without any such code the lowest residual wins.
+--m / --t pin the corresponding parameter.
+The residual model (hamm_residual_ber) relies on Coding::BCH::decode correcting
+t errors per block; past t it counts i + t wrong bits, an upper bound since blocks
+the decoder gives up on are left with their i errors.
+*/
+static void _pick_code(long in_size, int* m_out, int* t_out) {
+    double in_bits = (double)in_size * 8;
+    double best_cost = 0, best_residual = 1;
+    int met = 0;
+    for (int m = _m ? _m : MIN_M; m <= (_m ? _m : AUTO_MAX_M); m++) {
+        long n = (1L << m) - 1;
+        for (int t = _t ? _t : 1; t <= (_t ? _t : HAMM_SELECT_MAX_T); t++) {
+            long k = _information_bits(m, t);
+            if (k <= 0) break;
+
+            double residual = hamm_residual_ber(n, t, _ber);
+            double cost = (in_bits > 0 ? ceil(in_bits / k) : 1) * n;
+            int ok = residual <= _target_ber;
+            int take = !*m_out || (ok != met ? ok : ok ? cost < best_cost : residual < best_residual);
+            if (take) {
+                *m_out = m;
+                *t_out = t;
+                met = ok;
+                best_cost = cost;
+                best_residual = residual;
+            }
+
+            if (ok) break;
+        }
+    }
+
+    if (!met) cerr << "[bch_encode] no code reaches " << _target_ber << " at BER " << _ber << ", using the strongest one" << endl;
+}
+
+/*
+--m (or --pb) - Field degree, block length n = 2^m - 1 (default 15)
+--t - Correctable errors per block (default 3)
+--n / --k - Block length and minimal data bits per block instead of --m / --t
+--auto - Pick m and t for the input size, --ber and --target-ber (--m / --t pin one of them)
+--ber - Channel bit error rate estimate for --auto
+--target-ber - Acceptable residual bit error rate for --auto
+--target - Target file for encoding
+--out - Path to save location, starts with a hamm_header_t (HAMM_FLAG_BCH) recording m, t and the size
+*/
 int main(int argc, char* argv[]) {
     if (argc > 1) {
         for (int i = 1; i < argc; i++) {
-            if (!strcmp(argv[i], PARITY_BITS_ARG)) _m = atoi(argv[++i]);
-            else if (!strcmp(argv[i], TARGET_ARG)) _target = argv[++i];
-            else if (!strcmp(argv[i], OUTPUT_ARG)) _out_path = argv[++i];
+            const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+            if ((!strcmp(argv[i], PARITY_BITS_ARG) || !strcmp(argv[i], M_ARG)) && value) _m = atoi(argv[++i]);
+            else if (!strcmp(argv[i], T_ARG) && value) _t = atoi(argv[++i]);
+            else if (!strcmp(argv[i], N_ARG) && value) _n = atol(argv[++i]);
+            else if (!strcmp(argv[i], K_ARG) && value) _k = atol(argv[++i]);
+            else if (!strcmp(argv[i], AUTO_ARG)) _auto = 1;
+            else if (!strcmp(argv[i], BER_ARG) && value) _ber = atof(argv[++i]);
+            else if (!strcmp(argv[i], TARGET_BER_ARG) && value) _target_ber = atof(argv[++i]);
+            else if (!strcmp(argv[i], TARGET_ARG) && value) _target = argv[++i];
+            else if (!strcmp(argv[i], OUTPUT_ARG) && value) _out_path = argv[++i];
             else {
-                cerr << "Unknown argument: " << argv[i] << endl;
+                cerr << "Unknown argument or missing value: " << argv[i] << endl;
                 return EXIT_FAILURE;
             }
         }
     }
 
-    cout << "[bch_encode] _target=" << _target << ", _out_path=" << _out_path << ", _m=" << _m << endl;
+    if (_n) {
+        for (_m = MIN_M; _m <= MAX_M && (1L << _m) - 1 != _n; _m++);
+        if (_m > MAX_M) {
+            cerr << "--n must be 2^m - 1 with m in [" << MIN_M << ", " << MAX_M << "]" << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (_m && (_m < MIN_M || _m > MAX_M)) {
+        cerr << "--m must be in [" << MIN_M << ", " << MAX_M << "]" << endl;
+        return EXIT_FAILURE;
+    }
+
+    if (_k) {
+        int m = _m ? _m : 15;
+        for (_t = 0; _information_bits(m, _t + 1) >= _k; _t++);
+        if (!_t) {
+            cerr << "No code of length " << (1L << m) - 1 << " keeps " << _k << " data bits" << endl;
+            return EXIT_FAILURE;
+        }
+    }
 
     ifstream fin(_target, ios::binary);
     if (!fin) {
@@ -39,11 +144,25 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    vector<unsigned char> plain((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
-    fin.close();
+    error_code size_error;
+    long in_size = (long)filesystem::file_size(_target, size_error);
+    if (size_error) in_size = 0;
 
-    Coding::BCH bch(15, 7);
-    Coding::bytes encoded = bch.encode(plain);
+    if (_auto) {
+        int m = 0, t = 0;
+        _pick_code(in_size, &m, &t);
+        _m = m;
+        _t = t;
+    }
+
+    if (!_m) _m = 15;
+    if (!_t) _t = 3;
+    if (_information_bits(_m, _t) <= 0) {
+        cerr << "--t " << _t << " must be in [1, " << ((1L << _m) - 2) / 2 << "] and leave data bits in " << (1L << _m) - 1 << "-bit blocks" << endl;
+        return EXIT_FAILURE;
+    }
+
+    cout << "[bch_encode] _target=" << _target << ", _out_path=" << _out_path << ", _m=" << _m << ", _t=" << _t << endl;
 
     ofstream fout(_out_path, ios::binary);
     if (!fout) {
@@ -51,8 +170,23 @@ int main(int argc, char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    fout.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    hamm_header_t header = {};
+    header.magic = HAMM_MAGIC;
+    header.m = (unsigned char)_m;
+    header.flags = HAMM_FLAG_BCH;
+    header.reserved = (unsigned short)_t;
+    header.size = (unsigned long long)in_size;
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Streamed in groups of blocks, the file is never held in memory as a whole.
+    Coding::BCH bch(_m, 2 * _t + 1);
+    bch.encode(fin, fout);
+    fin.close();
     fout.close();
+    if (!fout) {
+        cerr << "Cannot write output file: " << _out_path << endl;
+        return EXIT_FAILURE;
+    }
 
     cout << "File encoded successfully: " << _out_path << endl;
     return EXIT_SUCCESS;
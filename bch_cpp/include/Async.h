@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <vector>
+#include <pool.h>
+namespace Coding {
+
+class AsyncOperation;
+
+class Cancelled : public std::runtime_error {
+public:
+    Cancelled() : std::runtime_error( "Operation cancelled" ) {}
+};
+
+// Shared by every async call of a reactor: bounds operations in flight (back-pressure)
+// and decides where finished coroutines resume. Without a resumer they resume on the
+// worker that finished the last chunk; an event loop passes one that posts the handle to itself.
+class AsyncContext {
+public:
+    typedef std::function<void( std::coroutine_handle<> )> Resumer;
+public:
+    explicit AsyncContext( size_t max_in_flight = 4096, Resumer resumer = {} );
+    AsyncContext( const AsyncContext& ) = delete;
+    AsyncContext& operator=( const AsyncContext& ) = delete;
+
+    size_t max_in_flight() const { return max_in_flight_; }
+    size_t in_flight() const;
+    size_t waiting() const;
+
+    static AsyncContext& shared();
+private:
+    friend class AsyncOperation;
+    bool acquire( AsyncOperation* op );
+    bool withdraw( AsyncOperation* op );
+    void release();
+    void resume( std::coroutine_handle<> handle );
+private:
+    size_t max_in_flight_;
+    Resumer resumer_;
+    mutable std::mutex lock_;
+    size_t in_flight_;
+    std::deque<AsyncOperation*> waiting_;
+};
+
+// Awaitable running chunk( 0 .. chunks - 1 ) on the library pool, each returning the bytes it produced
+// (or a negative value on failure). co_await yields the total, throws Cancelled once stop is requested
+// before all chunks ran, std::runtime_error if a chunk failed. Must be awaited once, not copied.
+class AsyncOperation {
+public:
+    typedef std::function<long( size_t chunk )> ChunkFn;
+public:
+    AsyncOperation( AsyncContext& context, size_t chunks, ChunkFn chunk, std::stop_token stop = {} );
+    AsyncOperation( const AsyncOperation& ) = delete;
+    AsyncOperation& operator=( const AsyncOperation& ) = delete;
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend( std::coroutine_handle<> handle );
+    size_t await_resume();
+private:
+    friend class AsyncContext;
+    struct Chunk {
+        pool_item_t item;
+        AsyncOperation* op;
+        size_t index;
+    };
+    struct Canceller {
+        AsyncOperation* op;
+        void operator()() const noexcept;
+    };
+    bool launch();
+    void finish_chunk();
+    static void run_chunk( void* ctx, long begin, long end );
+private:
+    AsyncContext& context_;
+    ChunkFn chunk_;
+    std::stop_token stop_;
+    std::vector<Chunk> chunks_;
+    std::coroutine_handle<> handle_;
+    std::atomic<size_t> left_;
+    std::atomic<long> produced_;
+    std::atomic<bool> cancelled_;
+    std::atomic<bool> failed_;
+    std::optional<std::stop_callback<Canceller>> on_stop_;
+};
+
+// Hamming array codec with blocking and awaitable entry points.
+// Async calls split the work in chunks of whole 8-block groups, so chunks run
+// on different workers and still produce the same bytes as one blocking call.
+class HammingCodec {
+public:
+    explicit HammingCodec( int parity_bits, AsyncContext& context = AsyncContext::shared() );
+
+    size_t encoded_size( size_t plain_size ) const;
+    size_t decoded_size( size_t cipher_size ) const;
+    size_t encode( std::span<const std::byte> in, std::span<std::byte> out ) const;
+    size_t decode( std::span<const std::byte> in, std::span<std::byte> out ) const;
+
+    // in and out must stay alive until the operation completes.
+    AsyncOperation encode_async( std::span<const std::byte> in, std::span<std::byte> out, std::stop_token stop = {} ) const;
+    AsyncOperation decode_async( std::span<const std::byte> in, std::span<std::byte> out, std::stop_token stop = {} ) const;
+private:
+    AsyncOperation run_async( std::span<const std::byte> in, std::span<std::byte> out, size_t in_group, size_t out_group,
+                              bool encode, std::stop_token stop ) const;
+private:
+    int parity_bits_;
+    AsyncContext& context_;
+};
+
+}
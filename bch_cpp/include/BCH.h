@@ -1,11 +1,30 @@
 #pragma once
 #include <vector>
 #include <set>
+#include <span>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
 #include "BinPolynom.h"
+#include "GF2m.h"
+#include "Utilities.h"
 namespace Coding {
 
 static const BinPolynom E = { 1 };
 
+// Thrown by decode once the whole input is decoded when blocks held more than t errors.
+// Those blocks are left as received, every other block is corrected.
+class Uncorrectable : public std::runtime_error {
+public:
+    explicit Uncorrectable( size_t blocks )
+        : std::runtime_error( "BCH blocks with more errors than the code corrects" ), blocks_( blocks ) {}
+    size_t blocks() const { return blocks_; }
+private:
+    size_t blocks_;
+};
+
 class BCH {
 public:
     typedef unsigned char byte;
@@ -14,15 +33,58 @@ public:
     BCH( size_t polynom_degree, size_t hamming_distance );
     bytes encode( const bytes& planeText );
     bytes decode( const bytes& cipherText );
+
+    // Zero-copy API: blocks are written straight into caller memory, no heap allocation per call.
+    // Blocks are coded in parallel on the shared worker pool (std/pool.h), 8-block groups per task.
+    // out must hold at least encoded_size( in.size() ) / decoded_size( in.size() ) bytes.
+    // Returns the written size without trailing zero bytes (same as the bytes overloads).
+    // decode corrects up to correctable() flipped bits per block and throws Uncorrectable past that.
+    size_t encode( std::span<const std::byte> in, std::span<std::byte> out );
+    size_t decode( std::span<const std::byte> in, std::span<std::byte> out );
+    // Streaming API: input is read in groups of 8 blocks, memory stays O(block) whatever the stream size.
+    // Writes the same bytes as the bytes overloads.
+    void encode( std::istream& in, std::ostream& out );
+    void decode( std::istream& in, std::ostream& out );
+    size_t encoded_size( size_t plain_size ) const;
+    size_t block_size() const { return size_; }
+    size_t information_symbols() const { return information_symbols_; }
+    size_t correctable() const { return ( hamming_distance_ - 1 ) / 2; }
+    // Generator degree of BCH( polynom_degree, hamming_distance ) without building the code
+    static size_t parity_bits( size_t polynom_degree, size_t hamming_distance );
+    size_t decoded_size( size_t cipher_size ) const;
+
+    // Syndromes S_1..S_{d-1} of the block of size_ bits at in_bit, all zero for a valid codeword.
+    // out must hold syndromes_qty() elements.
+    size_t syndromes_qty() const;
+    void syndromes( std::span<const std::byte> in, size_t in_bit, std::span<GF2m::element_t> out ) const;
+    const GF2m& field() const { return field_; }
 private:
-    BinPolynom::coefficients_t compute_coefficients_of_polynom( std::vector<size_t> conugates );
+    typedef uint64_t word_t;
+    struct BlocksJob;
+    static void run_blocks( void* ctx, long begin, long end );
+    // Returns the number of uncorrectable blocks (decode)
+    size_t code_blocks( const BlockView& view, std::span<std::byte> out, size_t out_bits, bool decode ) const;
+    // scratch holds 2 * scratch_words_ words, decode_block decoder_words_ more
+    void encode_block( const BlockView::Block& block, BitWriter& writer, word_t* scratch ) const;
+    // false when the block holds more errors than correctable(), it is decoded as received then
+    bool decode_block( const BlockView::Block& block, BitWriter& writer, word_t* scratch ) const;
+    void load_block( const BlockView::Block& block, word_t* block_words, word_t* result_words ) const;
+    void divide_block( word_t* block_words, word_t* result_words, size_t bits ) const;
+    // Berlekamp-Massey on the syndromes of the remainder and a Chien search over the first bits positions.
+    // Returns the error count (positions filled) or -1 when they do not make up a correctable pattern.
+    long locate_errors( const word_t* remainder, size_t bits, GF2m::element_t* work, GF2m::element_t* positions ) const;
+    // XORs the syndromes of the set bits of chunk (bit 0 at position first) into out
+    void add_syndromes( word_t chunk, size_t first, GF2m::element_t* out ) const;
 private:
     size_t size_;
     size_t information_symbols_;
     size_t hamming_distance_;
     BinPolynom generator_;
-    std::vector<BinPolynom> roots_;
-    
+    GF2m field_;
+    std::vector<word_t> generator_words_;
+    size_t scratch_words_;
+    size_t decoder_words_;
+
 };
 
 }
\ No newline at end of file
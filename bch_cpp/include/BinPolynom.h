@@ -12,19 +12,29 @@ public:
 public:
     BinPolynom( const std::initializer_list<coefficient_t>& init_list );
     BinPolynom( const coefficients_t& coefficients );
+    BinPolynom( coefficients_t&& coefficients );
     BinPolynom() = default;
 
     BinPolynom& operator+=( const BinPolynom& rhp );
     BinPolynom& operator-=( const BinPolynom& rhp );
     BinPolynom& operator*=( const BinPolynom& rhp );
     BinPolynom& operator<<=( size_t value );
-
-    BinPolynom operator+( const BinPolynom& rhp ) const;
-    BinPolynom operator-( const BinPolynom& rhp ) const;
-    BinPolynom operator*( const BinPolynom& rhp ) const;
-    BinPolynom operator<<( size_t value ) const;
+    // this += rhp * x^shift without building the shifted copy
+    BinPolynom& addmul_shifted( const BinPolynom& rhp, size_t shift );
+
+    // Temporaries on the left are reused instead of copied
+    BinPolynom operator+( const BinPolynom& rhp ) const&;
+    BinPolynom operator+( const BinPolynom& rhp ) &&;
+    BinPolynom operator-( const BinPolynom& rhp ) const&;
+    BinPolynom operator-( const BinPolynom& rhp ) &&;
+    BinPolynom operator*( const BinPolynom& rhp ) const&;
+    BinPolynom operator*( const BinPolynom& rhp ) &&;
+    BinPolynom operator<<( size_t value ) const&;
+    BinPolynom operator<<( size_t value ) &&;
     BinPolynom operator%( const BinPolynom& rhp ) const;
     std::pair<BinPolynom, BinPolynom> operator/( const BinPolynom& rhp ) const;
+    // Division into caller-owned polynoms, their storage is reused across calls
+    void divide( const BinPolynom& rhp, BinPolynom& quotient, BinPolynom& remainder ) const;
 
     bool operator==( const BinPolynom& rhp ) const;
     bool operator<( const BinPolynom& rhp ) const;
@@ -32,6 +42,7 @@ public:
     friend std::ostream& operator<<( std::ostream& os, const BinPolynom& rhp );
 
     coefficients_t get_coefficients() const;
+    const coefficients_t& coefficients() const { return coefficients_; }
 
     bool isZero() const;
     size_t degree() const;
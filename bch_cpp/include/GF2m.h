@@ -0,0 +1,82 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "Defines.h"
+#include "BinPolynom.h"
+namespace Coding {
+
+// GF(2^m): element bit i is the coefficient of alpha^i.
+// Up to MAX_TABLE_DEGREE arithmetic goes through log/antilog tables, above it through carry-less multiply.
+class GF2m {
+public:
+    typedef uint32_t element_t;
+    static const size_t MAX_TABLE_DEGREE = 16;
+public:
+    GF2m( size_t degree, const BinPolynom& primitive_polynom );
+
+    size_t degree() const { return degree_; }
+    element_t order() const { return order_; }
+
+    static constexpr element_t add( element_t a, element_t b ) { return a ^ b; }
+    element_t mul( element_t a, element_t b ) const {
+        if ( !a || !b ) return 0;
+        if ( tables_ ) return exp_[ log_[ a ] + log_[ b ] ];
+        return mul_slow( a, b );
+    }
+    element_t div( element_t a, element_t b ) const { return mul( a, inv( b ) ); }
+    element_t inv( element_t a ) const {
+        if ( tables_ ) return exp_[ order_ - log_[ a ] ];
+        return pow( a, order_ - 1 );
+    }
+    element_t pow( element_t a, uint64_t power ) const;
+    // alpha^power
+    element_t alpha( uint64_t power ) const {
+        if ( tables_ ) return exp_[ power % order_ ];
+        return pow( 2, power );
+    }
+    // Minimal polynom of alpha^power: product of (x + alpha^c) over the cyclotomic coset of power.
+    // Degree is at most m, so it is returned as a mask (bit i = coefficient of x^i).
+    uint64_t minimal_polynom( uint64_t power ) const;
+
+    // Table-free arithmetic modulo the primitive polynom mask of the given degree, usable at compile time.
+    static constexpr element_t mul_mod( element_t a, element_t b, size_t degree, uint64_t polynom ) {
+        uint64_t result = 0;
+        uint64_t shifted = a;
+        while ( b ) {
+            if ( b & 1 ) result ^= shifted;
+            b >>= 1;
+            shifted <<= 1;
+            if ( shifted >> degree ) shifted ^= polynom;
+        }
+        return element_t( result );
+    }
+    static constexpr element_t pow_mod( element_t a, uint64_t power, size_t degree, uint64_t polynom ) {
+        element_t result = 1;
+        while ( power ) {
+            if ( power & 1 ) result = mul_mod( result, a, degree, polynom );
+            a = mul_mod( a, a, degree, polynom );
+            power >>= 1;
+        }
+        return result;
+    }
+    // a^(2^m - 2), a must not be 0
+    static constexpr element_t inv_mod( element_t a, size_t degree, uint64_t polynom ) {
+        return pow_mod( a, ( uint64_t( 1 ) << degree ) - 2, degree, polynom );
+    }
+    static constexpr element_t div_mod( element_t a, element_t b, size_t degree, uint64_t polynom ) {
+        return mul_mod( a, inv_mod( b, degree, polynom ), degree, polynom );
+    }
+
+private:
+    element_t mul_slow( element_t a, element_t b ) const { return mul_mod( a, b, degree_, polynom_ ); }
+
+private:
+    size_t degree_;
+    element_t order_;
+    uint64_t polynom_;
+    bool tables_;
+    std::vector<element_t> exp_; // doubled so log(a) + log(b) never needs a modulo
+    std::vector<element_t> log_;
+};
+
+}
@@ -1,20 +1,105 @@
 #pragma once
+#include <functional>
+#include <iterator>
+#include <span>
+#include <cstddef>
+#include <cstdint>
 #include "Defines.h"
 #include "BinPolynom.h"
 
 namespace Coding {
 
+// Read-only view of a byte buffer as consecutive blocks of bits_per_block bits (LSB-first, the last block may be shorter).
+// Blocks are read straight from the buffer on demand, nothing is materialized.
+class BlockView {
+public:
+    class Block {
+    public:
+        Block( std::span<const std::byte> data, size_t bit, size_t bits );
+
+        // count <= 64 bits starting offset bits into the block, bits past the buffer read as zeros
+        uint64_t read( size_t offset, size_t count ) const;
+        bool operator[]( size_t index ) const;
+        size_t bits() const { return bits_; }
+        BinPolynom to_polynom() const;
+    private:
+        std::span<const std::byte> data_;
+        size_t bit_;
+        size_t bits_;
+    };
+
+    class iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef Block value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Block reference;
+        typedef void pointer;
+
+        iterator() = default;
+        iterator( const BlockView* view, size_t index ) : view_( view ), index_( index ) {}
+        Block operator*() const { return ( *view_ )[ index_ ]; }
+        iterator& operator++() { ++index_; return *this; }
+        iterator operator++( int ) { iterator it = *this; ++index_; return it; }
+        bool operator==( const iterator& rhp ) const { return index_ == rhp.index_; }
+    private:
+        const BlockView* view_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    BlockView( std::span<const std::byte> data, size_t bits_per_block );
+
+    size_t size() const;
+    Block operator[]( size_t index ) const;
+    iterator begin() const { return iterator( this, 0 ); }
+    iterator end() const { return iterator( this, size() ); }
+private:
+    std::span<const std::byte> data_;
+    size_t bits_per_block_;
+};
+
+// Sequential LSB-first bit writer, either into a fixed buffer or streaming whole bytes to a sink.
+class BitWriter {
+public:
+    typedef std::function<void( std::span<const std::byte> )> sink_t;
+
+    explicit BitWriter( std::span<std::byte> out );
+    explicit BitWriter( sink_t sink, size_t buffer_size = 1 << 16 );
+
+    // count <= 64 low bits of value
+    void write( uint64_t value, size_t count );
+    // bits coefficients of polynom, missing high ones written as zeros
+    void write( const BinPolynom& polynom, size_t bits );
+    size_t bits() const { return bits_; }
+    // Pads the last byte with zeros and hands everything to the sink, returns bytes written so far
+    size_t flush();
+private:
+    void emit( const std::byte* data, size_t size );
+private:
+    std::span<std::byte> out_;
+    sink_t sink_;
+    std::vector<std::byte> buffer_;
+    size_t pos_ = 0;
+    size_t written_ = 0;
+    size_t bits_ = 0;
+    uint64_t acc_ = 0;
+    size_t acc_bits_ = 0;
+};
+
 class Utilities {
 public:
     static std::vector<BinPolynom> get_primitive_polynoms_with_degree( size_t degree );
+    // Smallest primitive polynom of degree (<= 32), searched in parallel for large degrees
+    static BinPolynom find_primitive_polynom( size_t degree );
+    // Lazily walks primitive polynoms of degree in ascending order until callback returns false
+    static void for_each_primitive_polynom( size_t degree, const std::function<bool( const BinPolynom& )>& callback );
     static std::string to_string( const bytes& bytes_array );
     static bytes from_string( const std::string& str );
+    // Materializing wrappers over BlockView / BitWriter, prefer those for large inputs
     static std::vector<BinPolynom> split_to_binary_polynoms( const bytes& bytes_array, size_t bits_per_polynom );
     static bytes concat_binary_polynoms( const std::vector<BinPolynom>& binary_polynoms, size_t bits_per_polynom );
     static bytes& remove_zero_bytes_from_end( bytes& bytes_array );
 	static bytes remove_zero_bytes_from_end(const bytes& bytes_array);
-private:
-    static void remove_non_primitive_polynoms( const std::vector< std::vector<BinPolynom> >& primitive_polynoms, std::set<BinPolynom>& polynoms_of_degree, const size_t& degree, size_t minimal_degree = 0, size_t last_polynom_num = 0, BinPolynom to_remove = { 1 } );
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include <Async.h>
+#include <hamm/hamm.h>
+#include <algorithm>
+
+// Input bytes per async chunk, rounded to whole block groups.
+#define ASYNC_CHUNK_BYTES ( 256 * 1024 )
+namespace Coding {
+
+    AsyncContext::AsyncContext( size_t max_in_flight, Resumer resumer )
+        : max_in_flight_( std::max<size_t>( max_in_flight, 1 ) )
+        , resumer_( std::move( resumer ) )
+        , in_flight_( 0 )
+{
+}
+
+size_t AsyncContext::in_flight() const
+{
+    std::lock_guard<std::mutex> guard( lock_ );
+    return in_flight_;
+}
+
+size_t AsyncContext::waiting() const
+{
+    std::lock_guard<std::mutex> guard( lock_ );
+    return waiting_.size();
+}
+
+AsyncContext& AsyncContext::shared()
+{
+    static AsyncContext context;
+    return context;
+}
+
+// Take a slot or park op until release() hands one over.
+bool AsyncContext::acquire( AsyncOperation* op )
+{
+    std::lock_guard<std::mutex> guard( lock_ );
+    if ( in_flight_ < max_in_flight_ ) {
+        ++in_flight_;
+        return true;
+    }
+    waiting_.push_back( op );
+    return false;
+}
+
+bool AsyncContext::withdraw( AsyncOperation* op )
+{
+    std::lock_guard<std::mutex> guard( lock_ );
+    auto it = std::find( waiting_.begin(), waiting_.end(), op );
+    if ( it == waiting_.end() ) return false;
+    waiting_.erase( it );
+    return true;
+}
+
+// The slot passes straight to the oldest waiter, in_flight_ only drops when nobody waits.
+void AsyncContext::release()
+{
+    AsyncOperation* next = nullptr;
+    {
+        std::lock_guard<std::mutex> guard( lock_ );
+        if ( waiting_.empty() ) {
+            --in_flight_;
+            return;
+        }
+        next = waiting_.front();
+        waiting_.pop_front();
+    }
+    if ( !next->launch() ) resume( next->handle_ );
+}
+
+void AsyncContext::resume( std::coroutine_handle<> handle )
+{
+    if ( resumer_ ) resumer_( handle );
+    else handle.resume();
+}
+
+    AsyncOperation::AsyncOperation( AsyncContext& context, size_t chunks, ChunkFn chunk, std::stop_token stop )
+        : context_( context )
+        , chunk_( std::move( chunk ) )
+        , stop_( std::move( stop ) )
+        , chunks_( chunks )
+        , left_( 0 )
+        , produced_( 0 )
+        , cancelled_( false )
+        , failed_( false )
+{
+    for ( size_t i = 0; i < chunks; ++i ) {
+        chunks_[ i ] = { { run_chunk, &chunks_[ i ], nullptr }, this, i };
+    }
+}
+
+bool AsyncOperation::await_suspend( std::coroutine_handle<> handle )
+{
+    handle_ = handle;
+    if ( stop_.stop_requested() ) {
+        cancelled_ = true;
+        return false;
+    }
+
+    // While parked a stop request takes the operation out of the queue without waiting for a slot.
+    // Registered before parking, so the callback never runs on a half-built optional.
+    if ( stop_.stop_possible() ) on_stop_.emplace( stop_, Canceller{ this } );
+    if ( context_.acquire( this ) ) return launch();
+    return true;
+}
+
+size_t AsyncOperation::await_resume()
+{
+    on_stop_.reset();
+    if ( cancelled_ ) throw Cancelled();
+    if ( failed_ ) throw std::runtime_error( "Async codec call failed" );
+    return produced_;
+}
+
+void AsyncOperation::Canceller::operator()() const noexcept
+{
+    if ( !op->context_.withdraw( op ) ) return;
+    op->cancelled_ = true;
+    op->context_.resume( op->handle_ );
+}
+
+// Hands every chunk to the pool. The extra count held while submitting keeps a fast
+// worker (or chunks run inline by a single thread pool) from completing the operation
+// under our feet. Returns false when everything already finished here, the caller resumes the coroutine then.
+bool AsyncOperation::launch()
+{
+    left_ = chunks_.size() + 1;
+    for ( auto& chunk : chunks_ ) {
+        pool_submit( &chunk.item );
+    }
+    if ( left_.fetch_sub( 1 ) != 1 ) return true;
+    context_.release();
+    return false;
+}
+
+void AsyncOperation::finish_chunk()
+{
+    if ( left_.fetch_sub( 1 ) != 1 ) return;
+    // Last one out: after resume the operation may already be gone.
+    std::coroutine_handle<> handle = handle_;
+    AsyncContext& context = context_;
+    context.release();
+    context.resume( handle );
+}
+
+void AsyncOperation::run_chunk( void* ctx, long, long )
+{
+    Chunk* chunk = static_cast<Chunk*>( ctx );
+    AsyncOperation* op = chunk->op;
+    if ( op->cancelled_ || op->stop_.stop_requested() ) {
+        op->cancelled_ = true;
+    }
+    else {
+        long produced = -1;
+        try {
+            produced = op->chunk_( chunk->index );
+        }
+        catch ( ... ) {
+        }
+
+        if ( produced < 0 ) op->failed_ = true;
+        else op->produced_ += produced;
+    }
+
+    op->finish_chunk();
+}
+
+    HammingCodec::HammingCodec( int parity_bits, AsyncContext& context )
+        : parity_bits_( parity_bits )
+        , context_( context )
+{
+    if ( parity_bits < 2 || parity_bits > 16 ) throw std::runtime_error( "Unsupported parity bits count" );
+}
+
+size_t HammingCodec::encoded_size( size_t plain_size ) const
+{
+    return calculate_encoded_size( plain_size, parity_bits_ );
+}
+
+size_t HammingCodec::decoded_size( size_t cipher_size ) const
+{
+    return calculate_decoded_size( cipher_size, parity_bits_ );
+}
+
+size_t HammingCodec::encode( std::span<const std::byte> in, std::span<std::byte> out ) const
+{
+    if ( out.size() < encoded_size( in.size() ) ) throw std::runtime_error( "Output buffer is too small" );
+    long size = encode_hamming_array( reinterpret_cast<const byte_t*>( in.data() ), in.size(),
+                                      reinterpret_cast<byte_t*>( out.data() ), parity_bits_ );
+    if ( size < 0 ) throw std::runtime_error( "Hamming encode failed" );
+    return size;
+}
+
+size_t HammingCodec::decode( std::span<const std::byte> in, std::span<std::byte> out ) const
+{
+    if ( out.size() < decoded_size( in.size() ) ) throw std::runtime_error( "Output buffer is too small" );
+    long size = decode_hamming_array( reinterpret_cast<const byte_t*>( in.data() ), in.size(),
+                                      reinterpret_cast<byte_t*>( out.data() ), parity_bits_ );
+    if ( size < 0 ) throw std::runtime_error( "Hamming decode failed" );
+    return size;
+}
+
+// 8 blocks hold k data bytes and n code bytes: chunks cut on those groups line up
+// with the blocks of a single call.
+AsyncOperation HammingCodec::encode_async( std::span<const std::byte> in, std::span<std::byte> out, std::stop_token stop ) const
+{
+    if ( out.size() < encoded_size( in.size() ) ) throw std::runtime_error( "Output buffer is too small" );
+    size_t n = ( size_t( 1 ) << parity_bits_ ) - 1;
+    return run_async( in, out, n - parity_bits_, n, true, std::move( stop ) );
+}
+
+AsyncOperation HammingCodec::decode_async( std::span<const std::byte> in, std::span<std::byte> out, std::stop_token stop ) const
+{
+    if ( out.size() < decoded_size( in.size() ) ) throw std::runtime_error( "Output buffer is too small" );
+    size_t n = ( size_t( 1 ) << parity_bits_ ) - 1;
+    return run_async( in, out, n, n - parity_bits_, false, std::move( stop ) );
+}
+
+AsyncOperation HammingCodec::run_async( std::span<const std::byte> in, std::span<std::byte> out, size_t in_group, size_t out_group,
+                                        bool encode, std::stop_token stop ) const
+{
+    size_t groups = std::max<size_t>( ASYNC_CHUNK_BYTES / in_group, 1 );
+    size_t step = groups * in_group;
+    size_t chunks = ( in.size() + step - 1 ) / step;
+    int m = parity_bits_;
+    auto chunk = [ = ]( size_t i ) -> long {
+        size_t offset = i * step;
+        size_t size = std::min( step, in.size() - offset );
+        const byte_t* src = reinterpret_cast<const byte_t*>( in.data() ) + offset;
+        byte_t* dst = reinterpret_cast<byte_t*>( out.data() ) + i * groups * out_group;
+        return encode ? encode_hamming_array( src, size, dst, m ) : decode_hamming_array( src, size, dst, m );
+    };
+    return AsyncOperation( context_, chunks, chunk, std::move( stop ) );
+}
+
+}
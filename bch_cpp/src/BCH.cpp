@@ -1,110 +1,416 @@
 #include <BCH.h>
 #include <Utilities.h>
+#include <pool.h>
+#include <atomic>
 #include <iostream>
+#include <stdexcept>
 
 #define BPE(x) (E << (x))
+#define WORD_BITS 64
 namespace Coding {
 
-    BCH::BCH( size_t polynom_degree, size_t hamming_distance )
-        : size_( ( 1 << polynom_degree ) - 1 )
-        , information_symbols_( -1)
-        , hamming_distance_(hamming_distance)
-        , roots_( 1 << polynom_degree )
-        , generator_( E )
-{
-    const auto& primitive_polynoms = Utilities::get_primitive_polynoms_with_degree( polynom_degree );
-    assert( !primitive_polynoms.empty() );
-    dout << "All Primitive Polynoms of degree " << polynom_degree << ":\n";
-    for ( const auto& polynom : primitive_polynoms ) dout << polynom << std::endl;
+namespace {
+    // dst ^= src << shift, dst must have room for src.size() + 1 words past shift / WORD_BITS
+    void xor_shifted( uint64_t* dst, const std::vector<uint64_t>& src, size_t shift ) {
+        uint64_t* base = dst + shift / WORD_BITS;
+        size_t s = shift % WORD_BITS;
+        for ( size_t w = 0; w < src.size(); ++w ) {
+            base[ w ] ^= src[ w ] << s;
+            if ( s ) base[ w + 1 ] ^= src[ w ] >> ( WORD_BITS - s );
+        }
+    }
 
-    const BinPolynom& primitive_polynom = primitive_polynoms[ 0 ];
-   
-    for ( size_t i = 0; i < polynom_degree; ++i ) {
-        roots_[ i ] = BPE(i);
+    size_t trimmed_size( std::span<const std::byte> data, size_t size ) {
+        while ( size && data[ size - 1 ] == std::byte( 0 ) ) --size;
+        return size;
     }
 
-    BinPolynom::coefficients_t polynom_coefs = primitive_polynom.get_coefficients();
-    polynom_coefs.pop_back();
-    roots_[ polynom_degree ] = BinPolynom(polynom_coefs);
-    for ( size_t i = polynom_degree + 1; i < roots_.size(); ++i ) {
-        roots_[ i ] = roots_[ i - 1 ] * BPE( 1 );
-        if ( roots_[ i ].degree() == polynom_degree ) {
-            roots_[ i ] = roots_[ i ] - BPE( polynom_degree ) + roots_[ polynom_degree ];
+    // Input bytes per stream read, rounded to whole groups of 8 blocks
+    const size_t STREAM_CHUNK = 1 << 22;
+    // Bits per pool task at least, tasks always hold whole groups of 8 blocks so they never share an output byte
+    const long TASK_BITS = 1 << 16;
+
+    const size_t MAX_POLYNOM_DEGREE = 32;
+
+    // 2^m - 1, checked before the shift: GF2m elements are 32-bit wide
+    size_t code_length( size_t polynom_degree ) {
+        if ( polynom_degree == 0 || polynom_degree > MAX_POLYNOM_DEGREE ) {
+            throw std::invalid_argument( "BCH polynom degree must be in [1, 32]" );
         }
+        return ( size_t( 1 ) << polynom_degree ) - 1;
+    }
+
+    size_t stream_chunk( size_t block_bits ) {
+        return std::max<size_t>( 1, STREAM_CHUNK / block_bits ) * block_bits;
     }
 
-    dout << "Primitive Polynom: " << primitive_polynom << std::endl;
-    for ( size_t i = 0; i < roots_.size(); ++i ) dout << "Alpha[" << i << "]: " << roots_[ i ] << std::endl;
+    // Stream counterpart of trimmed_size: zero bytes are held back until something non-zero follows
+    class TrimmedSink {
+    public:
+        explicit TrimmedSink( std::ostream& out ) : out_( out ) {}
+        void operator()( std::span<const std::byte> data ) {
+            size_t size = trimmed_size( data, data.size() );
+            if ( size ) {
+                static const char zeros[ 4096 ] = {};
+                for ( ; zeros_; zeros_ -= std::min( zeros_, sizeof( zeros ) ) ) {
+                    out_.write( zeros, std::min( zeros_, sizeof( zeros ) ) );
+                }
+                out_.write( reinterpret_cast<const char*>( data.data() ), size );
+            }
+            zeros_ += data.size() - size;
+        }
+    private:
+        std::ostream& out_;
+        size_t zeros_ = 0;
+    };
+}
+
+    BCH::BCH( size_t polynom_degree, size_t hamming_distance )
+        : size_( code_length( polynom_degree ) )
+        , information_symbols_( -1)
+        , hamming_distance_(hamming_distance)
+        , generator_( E )
+        , field_( polynom_degree, Utilities::find_primitive_polynom( polynom_degree ) )
+{
+    dout << "Field order: " << field_.order() << std::endl;
+    if ( hamming_distance > size_ ) throw std::invalid_argument( "BCH hamming distance exceeds the block size 2^m - 1" );
 
-    std::vector<bool> used_roots( roots_.size(), false );
+    // Generator: product of minimal polynoms of alpha^1..alpha^(d-1), each coset taken once.
+    // Multiplied as packed words, a minimal polynom is a single word mask.
+    generator_words_.assign( 1, 1 );
+    std::vector<bool> used_roots( std::min<size_t>( hamming_distance, size_ + 1 ), false );
     used_roots[ 0 ] = true;
-    used_roots[ roots_.size() - 1 ] = true;
     for ( size_t i = 1, c = 0; i < used_roots.size() && c < hamming_distance - 1; ++i, ++c ) {
         if ( used_roots[ i ] == false ) {
-            std::vector<size_t> conugates;
-            conugates.push_back( i );
-            used_roots[ i ] = true;
-            size_t ring = size_;
-            size_t k = ( i << 1 ) % ring;
-            dout << i;
-            while ( k != i ) {
-                conugates.push_back( k );
-                used_roots[ k ] = true;
-                dout << " " << k;
-                k = ( ( k << 1 ) % ring );
-                if ( !k ) k = ring;
+            size_t k = i;
+            do {
+                if ( k < used_roots.size() ) used_roots[ k ] = true;
+                dout << k << " ";
+                k = ( k << 1 ) % size_;
+                if ( !k ) k = size_; // alpha^size_ = 1, its coset is itself
+            } while ( k != i );
+            uint64_t polynom = field_.minimal_polynom( i );
+            dout << std::endl << std::hex << polynom << std::dec << std::endl;
+
+            std::vector<word_t> product( generator_words_.size() + 2, 0 );
+            for ( ; polynom; polynom &= polynom - 1 ) {
+                xor_shifted( product.data(), generator_words_, __builtin_ctzll( polynom ) );
             }
-            BinPolynom polynom( compute_coefficients_of_polynom( conugates ) );
-            dout << std::endl << polynom << std::endl;
-            generator_ *= polynom;
+            while ( product.size() > 1 && !product.back() ) product.pop_back();
+            generator_words_.swap( product );
         }
     }
+
+    size_t generator_degree = ( generator_words_.size() - 1 ) * WORD_BITS + 63 - __builtin_clzll( generator_words_.back() );
+    BinPolynom::coefficients_t generator_coefs( generator_degree + 1 );
+    for ( size_t i = 0; i <= generator_degree; ++i ) {
+        generator_coefs[ i ] = ( generator_words_[ i / WORD_BITS ] >> ( i % WORD_BITS ) ) & 1;
+    }
+    generator_ = BinPolynom( std::move( generator_coefs ) );
     dout << "Generator: " << generator_ << std::endl;
     information_symbols_ =  size_ - generator_.degree();
+
+    scratch_words_ = ( size_ + WORD_BITS - 1 ) / WORD_BITS + generator_words_.size() + 1;
+    // Decoder work: syndromes, BM connection / previous / temporary polynoms and positions, d + 1 elements each
+    decoder_words_ = ( 5 * ( hamming_distance_ + 1 ) * sizeof( GF2m::element_t ) + sizeof( word_t ) - 1 ) / sizeof( word_t );
 }
 
 bytes BCH::encode( const bytes & planeText )
 {
-    std::vector<BinPolynom> cipherPolynoms;
-    for ( const auto& polynom : Utilities::split_to_binary_polynoms( planeText, information_symbols_ ) ) {
-        cipherPolynoms.push_back( polynom * generator_ );
-    }
-    return Utilities::remove_zero_bytes_from_end( Utilities::concat_binary_polynoms(cipherPolynoms, size_));
+    bytes cipherText( encoded_size( planeText.size() ) );
+    cipherText.resize( encode( std::as_bytes( std::span( planeText ) ), std::as_writable_bytes( std::span( cipherText ) ) ) );
+    return cipherText;
 }
 
 bytes BCH::decode( const bytes & cipherText )
 {
-    std::vector<BinPolynom> cipherPolynoms;
-    for ( const auto& polynom : Utilities::split_to_binary_polynoms( cipherText, size_ ) ) {
-        cipherPolynoms.push_back( (polynom / generator_).first );
+    bytes planeText( decoded_size( cipherText.size() ) );
+    planeText.resize( decode( std::as_bytes( std::span( cipherText ) ), std::as_writable_bytes( std::span( planeText ) ) ) );
+    return planeText;
+}
+
+size_t BCH::encoded_size( size_t plain_size ) const
+{
+    size_t blocks = ( plain_size * 8 + information_symbols_ - 1 ) / information_symbols_;
+    return ( blocks * size_ + 7 ) / 8;
+}
+
+size_t BCH::decoded_size( size_t cipher_size ) const
+{
+    size_t blocks = ( cipher_size * 8 + size_ - 1 ) / size_;
+    return ( blocks * information_symbols_ + 7 ) / 8;
+}
+
+struct BCH::BlocksJob {
+    const BCH* self;
+    const BlockView* view;
+    std::span<std::byte> out;
+    size_t out_bits;
+    bool decode;
+    std::atomic<bool> failed;
+    std::atomic<size_t> uncorrectable;
+};
+
+void BCH::run_blocks( void* ctx, long begin, long end )
+{
+    BlocksJob* job = static_cast<BlocksJob*>( ctx );
+    const BCH* self = job->self;
+    word_t* scratch = static_cast<word_t*>( pool_scratch( ( 2 * self->scratch_words_ + self->decoder_words_ ) * sizeof( word_t ) ) );
+    if ( !scratch ) {
+        job->failed = true;
+        return;
+    }
+
+    size_t first = begin * job->out_bits / 8;
+    size_t last = std::min( job->out.size(), ( end * job->out_bits + 7 ) / 8 );
+    BitWriter writer( job->out.subspan( first, last - first ) );
+    for ( long b = begin; b < end; ++b ) {
+        if ( job->decode ) {
+            if ( !self->decode_block( ( *job->view )[ b ], writer, scratch ) ) job->uncorrectable++;
+        }
+        else self->encode_block( ( *job->view )[ b ], writer, scratch );
+    }
+    writer.flush();
+}
+
+// Every block is independent: tasks cover whole 8-block groups, so each one owns its output bytes
+size_t BCH::code_blocks( const BlockView& view, std::span<std::byte> out, size_t out_bits, bool decode ) const
+{
+    BlocksJob job{ this, &view, out, out_bits, decode, { false }, { 0 } };
+    long grain = std::max<long>( 8, TASK_BITS / (long)size_ );
+    pool_parallel_for( view.size(), grain, 8, run_blocks, &job );
+    if ( job.failed ) {
+        throw std::bad_alloc();
     }
-    return Utilities::remove_zero_bytes_from_end(Utilities::concat_binary_polynoms( cipherPolynoms, information_symbols_ ));
+    return job.uncorrectable;
 }
 
-BinPolynom::coefficients_t BCH::compute_coefficients_of_polynom( std::vector<size_t> conugates )
+size_t BCH::encode( std::span<const std::byte> in, std::span<std::byte> out )
 {
-    typedef size_t mask_t;
-    BinPolynom::coefficients_t coefficients( conugates.size() + 1 );
-    std::vector<BinPolynom> coefficients_helper(conugates.size() + 1);
-    mask_t me = 1ll << conugates.size();
-    for ( mask_t mi = 0; mi != me; ++mi ) {
-        size_t root_number = 0;
-        size_t x_degree = conugates.size();
+    size_t out_size = encoded_size( in.size() );
+    if ( out.size() < out_size ) {
+        throw std::runtime_error( "Output buffer is too small" );
+    }
+    if ( out_size ) out[ out_size - 1 ] = std::byte( 0 );
 
-        for ( size_t p = 0; p < coefficients.size(); ++p ) {
-            if ( mi & ( 1 << p ) ) {
-                root_number += conugates[ p ];
-                --x_degree;
-            }
+    code_blocks( BlockView( in, information_symbols_ ), out.first( out_size ), size_, false );
+    return trimmed_size( out, out_size );
+}
+
+size_t BCH::decode( std::span<const std::byte> in, std::span<std::byte> out )
+{
+    size_t out_size = decoded_size( in.size() );
+    if ( out.size() < out_size ) {
+        throw std::runtime_error( "Output buffer is too small" );
+    }
+    if ( out_size ) out[ out_size - 1 ] = std::byte( 0 );
+
+    size_t uncorrectable = code_blocks( BlockView( in, size_ ), out.first( out_size ), information_symbols_, true );
+    if ( uncorrectable ) throw Uncorrectable( uncorrectable );
+    return trimmed_size( out, out_size );
+}
+
+// Chunks hold whole 8-block groups, so coded chunks concatenate into the one-shot output
+void BCH::encode( std::istream& in, std::ostream& out )
+{
+    TrimmedSink sink( out );
+    bytes chunk( stream_chunk( information_symbols_ ) );
+    bytes coded( encoded_size( chunk.size() ) );
+    while ( in.read( reinterpret_cast<char*>( chunk.data() ), chunk.size() ) || in.gcount() ) {
+        size_t size = encoded_size( in.gcount() );
+        coded[ size - 1 ] = 0;
+        code_blocks( BlockView( std::as_bytes( std::span( chunk ) ).first( in.gcount() ), information_symbols_ ),
+                     std::as_writable_bytes( std::span( coded ) ).first( size ), size_, false );
+        sink( std::as_bytes( std::span( coded ) ).first( size ) );
+    }
+}
+
+void BCH::decode( std::istream& in, std::ostream& out )
+{
+    TrimmedSink sink( out );
+    bytes chunk( stream_chunk( size_ ) );
+    bytes plain( decoded_size( chunk.size() ) );
+    size_t uncorrectable = 0;
+    while ( in.read( reinterpret_cast<char*>( chunk.data() ), chunk.size() ) || in.gcount() ) {
+        size_t size = decoded_size( in.gcount() );
+        plain[ size - 1 ] = 0;
+        uncorrectable += code_blocks( BlockView( std::as_bytes( std::span( chunk ) ).first( in.gcount() ), size_ ),
+                     std::as_writable_bytes( std::span( plain ) ).first( size ), information_symbols_, true );
+        sink( std::as_bytes( std::span( plain ) ).first( size ) );
+    }
+    if ( uncorrectable ) throw Uncorrectable( uncorrectable );
+}
+
+// c(x) = m(x) * g(x): one shifted copy of the generator per set message bit
+void BCH::encode_block( const BlockView::Block& block, BitWriter& writer, word_t* scratch ) const
+{
+    word_t* block_words = scratch;
+    std::fill( block_words, block_words + scratch_words_, 0 );
+    for ( size_t i = 0; i < block.bits(); i += WORD_BITS ) {
+        word_t chunk = block.read( i, std::min<size_t>( WORD_BITS, block.bits() - i ) );
+        while ( chunk ) {
+            xor_shifted( block_words, generator_words_, i + __builtin_ctzll( chunk ) );
+            chunk &= chunk - 1;
+        }
+    }
+    for ( size_t i = 0; i < size_; i += WORD_BITS ) {
+        writer.write( block_words[ i / WORD_BITS ], std::min<size_t>( WORD_BITS, size_ - i ) );
+    }
+}
+
+void BCH::load_block( const BlockView::Block& block, word_t* block_words, word_t* result_words ) const
+{
+    std::fill( block_words, block_words + scratch_words_, 0 );
+    std::fill( result_words, result_words + scratch_words_, 0 );
+    for ( size_t i = 0; i < block.bits(); i += WORD_BITS ) {
+        block_words[ i / WORD_BITS ] = block.read( i, std::min<size_t>( WORD_BITS, block.bits() - i ) );
+    }
+}
+
+// Long division by g(x): quotient into result_words, the remainder stays in block_words
+void BCH::divide_block( word_t* block_words, word_t* result_words, size_t bits ) const
+{
+    size_t generator_degree = generator_.degree();
+    for ( size_t i = bits; i-- > generator_degree; ) {
+        if ( ( block_words[ i / WORD_BITS ] >> ( i % WORD_BITS ) ) & 1 ) {
+            size_t shift = i - generator_degree;
+            result_words[ shift / WORD_BITS ] |= word_t( 1 ) << ( shift % WORD_BITS );
+            xor_shifted( block_words, generator_words_, shift );
         }
-        root_number %= roots_.size() - 1;
-        coefficients_helper[ x_degree ] += roots_[ root_number ];
     }
-    for ( size_t i = 0; i < coefficients_helper.size(); ++i ) {
-        assert( coefficients_helper[ i ].degree() == 0 );
-        coefficients[ i ] = !coefficients_helper[ i ].isZero();
+}
+
+// r = q * g + rem with g( alpha^j ) = 0 for j = 1..d-1, so the short remainder has the syndromes of r.
+// Errors are rare: flipped bits are located there, fixed in a fresh copy and the copy is divided again.
+bool BCH::decode_block( const BlockView::Block& block, BitWriter& writer, word_t* scratch ) const
+{
+    word_t* block_words = scratch;
+    word_t* result_words = scratch + scratch_words_;
+    load_block( block, block_words, result_words );
+    divide_block( block_words, result_words, block.bits() );
+
+    bool ok = true;
+    size_t generator_degree = generator_.degree();
+    bool clean = true;
+    for ( size_t i = 0; i < generator_degree; i += WORD_BITS ) clean = clean && !block_words[ i / WORD_BITS ];
+    if ( !clean ) {
+        GF2m::element_t* work = reinterpret_cast<GF2m::element_t*>( scratch + 2 * scratch_words_ );
+        GF2m::element_t* positions = work + 4 * ( hamming_distance_ + 1 );
+        long errors = locate_errors( block_words, block.bits(), work, positions );
+        ok = errors >= 0;
+        if ( ok ) {
+            load_block( block, block_words, result_words );
+            for ( long e = 0; e < errors; ++e ) block_words[ positions[ e ] / WORD_BITS ] ^= word_t( 1 ) << ( positions[ e ] % WORD_BITS );
+            divide_block( block_words, result_words, block.bits() );
+        }
+    }
+    for ( size_t i = 0; i < information_symbols_; i += WORD_BITS ) {
+        writer.write( result_words[ i / WORD_BITS ], std::min<size_t>( WORD_BITS, information_symbols_ - i ) );
+    }
+    return ok;
+}
+
+long BCH::locate_errors( const word_t* remainder, size_t bits, GF2m::element_t* work, GF2m::element_t* positions ) const
+{
+    size_t qty = syndromes_qty();
+    size_t room = hamming_distance_ + 1;
+    GF2m::element_t* syndromes = work;
+    GF2m::element_t* connection = work + room;
+    GF2m::element_t* previous = work + 2 * room;
+    GF2m::element_t* temporary = work + 3 * room;
+
+    // S_j = rem( alpha^j ), j = 1..d-1
+    std::fill( syndromes, syndromes + qty, 0 );
+    size_t generator_degree = generator_.degree();
+    for ( size_t i = 0; i < generator_degree; i += WORD_BITS ) {
+        add_syndromes( remainder[ i / WORD_BITS ] & ( generator_degree - i >= WORD_BITS ? ~word_t( 0 ) : ( word_t( 1 ) << ( generator_degree - i ) ) - 1 ), i, syndromes );
+    }
+
+    // Berlekamp-Massey: shortest LFSR C( x ) generating S, its roots are the inverse error locations
+    std::fill( connection, connection + room, 0 );
+    std::fill( previous, previous + room, 0 );
+    connection[ 0 ] = previous[ 0 ] = 1;
+    size_t length = 0, gap = 1;
+    GF2m::element_t last = 1;
+    for ( size_t n = 0; n < qty; ++n ) {
+        GF2m::element_t discrepancy = syndromes[ n ];
+        for ( size_t i = 1; i <= length; ++i ) discrepancy ^= field_.mul( connection[ i ], syndromes[ n - i ] );
+        if ( !discrepancy ) {
+            ++gap;
+            continue;
+        }
+        GF2m::element_t scale = field_.div( discrepancy, last );
+        std::copy( connection, connection + room, temporary );
+        for ( size_t i = 0; i + gap < room; ++i ) connection[ i + gap ] ^= field_.mul( scale, previous[ i ] );
+        if ( 2 * length <= n ) {
+            length = n + 1 - length;
+            std::copy( temporary, temporary + room, previous );
+            last = discrepancy;
+            gap = 1;
+        }
+        else ++gap;
+    }
+    if ( length > correctable() ) return -1;
+
+    // Chien search: bit i is in error when C( alpha^-i ) = 0, terms[ k ] runs through C_k * alpha^-ik
+    GF2m::element_t* terms = temporary;
+    std::copy( connection, connection + length + 1, terms );
+    long found = 0;
+    for ( size_t i = 0; i < bits && found < (long)length; ++i ) {
+        GF2m::element_t sum = 0;
+        for ( size_t k = 0; k <= length; ++k ) sum ^= terms[ k ];
+        if ( !sum ) positions[ found++ ] = GF2m::element_t( i );
+        for ( size_t k = 1; k <= length; ++k ) terms[ k ] = field_.mul( terms[ k ], field_.alpha( field_.order() - k ) );
+    }
+    return found == (long)length ? found : -1;
+}
+
+// Same coset walk as the constructor, each coset adds its size to the generator degree
+size_t BCH::parity_bits( size_t polynom_degree, size_t hamming_distance )
+{
+    size_t size = code_length( polynom_degree );
+    std::vector<bool> used_roots( std::min<size_t>( hamming_distance, size + 1 ), false );
+    size_t degree = 0;
+    for ( size_t i = 1; i < used_roots.size(); ++i ) {
+        if ( used_roots[ i ] ) continue;
+        size_t k = i;
+        do {
+            if ( k < used_roots.size() ) used_roots[ k ] = true;
+            ++degree;
+            k = ( k << 1 ) % size;
+            if ( !k ) k = size;
+        } while ( k != i );
+    }
+    return degree;
+}
+
+size_t BCH::syndromes_qty() const
+{
+    return hamming_distance_ - 1;
+}
+
+void BCH::syndromes( std::span<const std::byte> in, size_t in_bit, std::span<GF2m::element_t> out ) const
+{
+    std::fill( out.begin(), out.begin() + syndromes_qty(), 0 );
+    BlockView::Block block( in, in_bit, std::min( size_, in.size() * 8 - std::min( in.size() * 8, in_bit ) ) );
+    for ( size_t i = 0; i < block.bits(); i += WORD_BITS ) {
+        add_syndromes( block.read( i, std::min<size_t>( WORD_BITS, block.bits() - i ) ), i, out.data() );
+    }
+}
+
+// S_j = r(alpha^j): every set bit i adds beta^j with beta = alpha^i, powers taken by running product
+void BCH::add_syndromes( word_t chunk, size_t first, GF2m::element_t* out ) const
+{
+    size_t qty = syndromes_qty();
+    while ( chunk ) {
+        GF2m::element_t beta = field_.alpha( first + __builtin_ctzll( chunk ) );
+        GF2m::element_t power = beta;
+        for ( size_t j = 0; j < qty; ++j ) {
+            out[ j ] ^= power;
+            power = field_.mul( power, beta );
+        }
+        chunk &= chunk - 1;
     }
-    return coefficients;
 }
 
 }
@@ -17,6 +17,11 @@ namespace Coding {
             throw std::runtime_error( "Coefficient of max degree must be 1" );
         }
     }
+    BinPolynom::BinPolynom( coefficients_t&& coefficients )
+        : coefficients_( std::move( coefficients ) )
+    {
+        trim();
+    }
 
     BinPolynom& BinPolynom::operator+=( const BinPolynom& rhp ) {
         if ( rhp.coefficients_.size() > coefficients_.size() ) {
@@ -31,71 +36,105 @@ namespace Coding {
     BinPolynom& BinPolynom::operator-=( const BinPolynom& rhp ) {
         return operator+=( rhp );
     }
+    // The product goes to a per-thread scratch that is swapped in, so the old storage is reused next time
     BinPolynom& BinPolynom::operator*=( const BinPolynom& rhp ) {
         if ( isZero() || rhp.isZero() ) {
             coefficients_.clear();
             return *this;
         }
-        coefficients_t new_coefficients( coefficients_.size() + rhp.coefficients_.size() - 1, 0 );
+        static thread_local coefficients_t scratch;
+        scratch.assign( coefficients_.size() + rhp.coefficients_.size() - 1, false );
         for ( size_t i = 0; i < coefficients_.size(); ++i ) {
+            if ( !coefficients_[ i ] ) continue;
             for ( size_t j = 0; j < rhp.coefficients_.size(); ++j ) {
-                new_coefficients[ i + j ] = new_coefficients[ i + j ] ^ ( coefficients_[ i ] & rhp.coefficients_[ j ] );
+                scratch[ i + j ] = scratch[ i + j ] ^ rhp.coefficients_[ j ];
             }
         }
-        coefficients_.swap( new_coefficients );
+        coefficients_.swap( scratch );
         trim();
         return *this;
     }
     BinPolynom& BinPolynom::operator<<=( size_t value ) {
-        coefficients_t new_coefficients( value, 0 );
-        new_coefficients.insert( new_coefficients.end(), coefficients_.begin(), coefficients_.end() );
-        coefficients_.swap( new_coefficients );
+        if ( !isZero() ) {
+            coefficients_.insert( coefficients_.begin(), value, false );
+        }
+        return *this;
+    }
+    // Walks down so that rhp may be *this, rhp's size is taken before the resize grows it too
+    BinPolynom& BinPolynom::addmul_shifted( const BinPolynom& rhp, size_t shift ) {
+        if ( rhp.isZero() ) {
+            return *this;
+        }
+        size_t rhp_size = rhp.coefficients_.size();
+        if ( rhp_size + shift > coefficients_.size() ) {
+            coefficients_.resize( rhp_size + shift );
+        }
+        for ( size_t i = rhp_size; i-- > 0; ) {
+            coefficients_[ i + shift ] = coefficients_[ i + shift ] ^ rhp.coefficients_[ i ];
+        }
+        trim();
         return *this;
     }
 
-    BinPolynom BinPolynom::operator+( const BinPolynom& rhp ) const {
+    BinPolynom BinPolynom::operator+( const BinPolynom& rhp ) const& {
         BinPolynom resBinPolynom( *this );
         return resBinPolynom += rhp;
     }
-    BinPolynom BinPolynom::operator-( const BinPolynom& rhp ) const {
+    BinPolynom BinPolynom::operator+( const BinPolynom& rhp ) && {
+        return std::move( *this += rhp );
+    }
+    BinPolynom BinPolynom::operator-( const BinPolynom& rhp ) const& {
         BinPolynom resBinPolynom( *this );
         return resBinPolynom -= rhp;
     }
-    BinPolynom BinPolynom::operator*( const BinPolynom& rhp ) const {
+    BinPolynom BinPolynom::operator-( const BinPolynom& rhp ) && {
+        return std::move( *this -= rhp );
+    }
+    BinPolynom BinPolynom::operator*( const BinPolynom& rhp ) const& {
         BinPolynom resBinPolynom( *this );
         return resBinPolynom *= rhp;
     }
-    BinPolynom BinPolynom::operator<<( size_t value ) const {
+    BinPolynom BinPolynom::operator*( const BinPolynom& rhp ) && {
+        return std::move( *this *= rhp );
+    }
+    BinPolynom BinPolynom::operator<<( size_t value ) const& {
         BinPolynom resBinPolynom( *this );
         return resBinPolynom <<= value;
     }
+    BinPolynom BinPolynom::operator<<( size_t value ) && {
+        return std::move( *this <<= value );
+    }
     BinPolynom BinPolynom::operator%( const BinPolynom& rhp ) const {
-        return operator/( rhp ).second;
+        BinPolynom quotient, remainder;
+        divide( rhp, quotient, remainder );
+        return remainder;
     }
     std::pair<BinPolynom, BinPolynom> BinPolynom::operator/( const BinPolynom& rhp ) const {
+        std::pair<BinPolynom, BinPolynom> result;
+        divide( rhp, result.first, result.second );
+        return result;
+    }
+    // Long division in place: remainder starts as a copy of *this and loses its leading term each step
+    void BinPolynom::divide( const BinPolynom& rhp, BinPolynom& quotient, BinPolynom& remainder ) const {
         if ( rhp.isZero() ) {
             throw std::runtime_error( "Divisor cannot be Zero!" );
         }
-
-        if ( rhp.coefficients_.size() > coefficients_.size() ) {
-            return std::make_pair( BinPolynom(), *this );
+        if ( &rhp == &quotient || &rhp == &remainder ) {
+            BinPolynom divisor( rhp );
+            divide( divisor, quotient, remainder );
+            return;
         }
 
-        BinPolynom quotient;
-
-        quotient.coefficients_.resize( coefficients_.size() - rhp.coefficients_.size() + 1 );
-
-        BinPolynom dividend = *this;
-        const BinPolynom& divisor = rhp;
-        while ( dividend.coefficients_.size() >= divisor.coefficients_.size() ) {
-            size_t BinPolynom_degree = dividend.coefficients_.size() - divisor.coefficients_.size();
-
-            quotient.coefficients_[ BinPolynom_degree ] = dividend.coefficients_.back();
-            dividend -= ( BinPolynom( { dividend.coefficients_.back() } ) << BinPolynom_degree ) * divisor;
+        size_t divisor_size = rhp.coefficients_.size();
+        size_t quotient_size = coefficients_.size() >= divisor_size ? coefficients_.size() - divisor_size + 1 : 0;
+        remainder.coefficients_ = coefficients_;
+        quotient.coefficients_.assign( quotient_size, false );
+        while ( remainder.coefficients_.size() >= divisor_size ) {
+            size_t shift = remainder.coefficients_.size() - divisor_size;
+            quotient.coefficients_[ shift ] = true;
+            remainder.addmul_shifted( rhp, shift );
         }
-        dividend.trim();
         quotient.trim();
-        return std::make_pair( quotient, dividend );
     }
 
     bool BinPolynom::operator==( const BinPolynom& rhp ) const {
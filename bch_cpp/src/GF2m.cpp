@@ -0,0 +1,62 @@
+#include <GF2m.h>
+#include <stdexcept>
+
+namespace Coding {
+
+GF2m::GF2m( size_t degree, const BinPolynom& primitive_polynom )
+    : degree_( degree )
+    , order_( element_t( ( uint64_t( 1 ) << degree ) - 1 ) )
+    , polynom_( 0 )
+    , tables_( degree <= MAX_TABLE_DEGREE )
+{
+    if ( degree == 0 || degree > 32 || primitive_polynom.degree() != degree ) {
+        throw std::runtime_error( "Field degree must match primitive polynom degree and be in [1, 32]" );
+    }
+
+    const BinPolynom::coefficients_t& coefficients = primitive_polynom.coefficients();
+    for ( size_t i = 0; i < coefficients.size(); ++i ) {
+        if ( coefficients[ i ] ) polynom_ |= uint64_t( 1 ) << i;
+    }
+
+    if ( tables_ ) {
+        exp_.resize( 2 * size_t( order_ ) + 1 );
+        log_.resize( size_t( order_ ) + 1 );
+        uint64_t value = 1;
+        for ( element_t i = 0; i < order_; ++i ) {
+            exp_[ i ] = exp_[ i + order_ ] = element_t( value );
+            log_[ value ] = i;
+            value <<= 1;
+            if ( value >> degree_ ) value ^= polynom_;
+        }
+        exp_[ 2 * size_t( order_ ) ] = exp_[ 0 ];
+    }
+}
+
+GF2m::element_t GF2m::pow( element_t a, uint64_t power ) const {
+    if ( !a ) return power ? 0 : 1;
+    if ( tables_ ) return exp_[ ( uint64_t( log_[ a ] ) * ( power % order_ ) ) % order_ ];
+    return pow_mod( a, power, degree_, polynom_ );
+}
+
+uint64_t GF2m::minimal_polynom( uint64_t power ) const {
+    std::vector<element_t> coefficients = { 1 };
+    uint64_t conjugate = power % order_;
+    do {
+        element_t root = alpha( conjugate );
+        coefficients.push_back( 0 );
+        for ( size_t i = coefficients.size() - 1; i > 0; --i ) {
+            coefficients[ i ] = add( coefficients[ i - 1 ], mul( coefficients[ i ], root ) );
+        }
+        coefficients[ 0 ] = mul( coefficients[ 0 ], root );
+        conjugate = ( conjugate * 2 ) % order_;
+    } while ( conjugate != power % order_ );
+
+    uint64_t mask = 0;
+    for ( size_t i = 0; i < coefficients.size(); ++i ) {
+        assert( coefficients[ i ] <= 1 );
+        mask |= uint64_t( coefficients[ i ] ) << i;
+    }
+    return mask;
+}
+
+}
@@ -1,41 +1,269 @@
 #include "Utilities.h"
+#include <atomic>
+#include <thread>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
 namespace Coding {
 
-void Utilities::remove_non_primitive_polynoms( const std::vector<std::vector<BinPolynom>>& primitive_polynoms, std::set<BinPolynom>& polynoms_of_degree, const size_t & degree, size_t minimal_degree, size_t last_polynom_num, BinPolynom to_remove ) {
-    if ( to_remove.degree() == degree ) {
-        polynoms_of_degree.erase( to_remove );
+namespace {
+    const size_t MAX_PRIMITIVE_DEGREE = 32;
+    const size_t PARALLEL_SEARCH_DEGREE = 16;
+
+    // a * b mod p over GF(2), a and b already reduced (degree < degree of p)
+    uint64_t gf2_mulmod( uint64_t a, uint64_t b, uint64_t p, size_t degree ) {
+        uint64_t result = 0;
+        uint64_t top = uint64_t( 1 ) << degree;
+        while ( b ) {
+            if ( b & 1 ) result ^= a;
+            b >>= 1;
+            a <<= 1;
+            if ( a & top ) a ^= p;
+        }
+        return result;
+    }
+
+    uint64_t gf2_powmod_x( uint64_t exponent, uint64_t p, size_t degree ) {
+        uint64_t result = 1;
+        uint64_t base = degree > 1 ? 2 : 2 ^ p;
+        while ( exponent ) {
+            if ( exponent & 1 ) result = gf2_mulmod( result, base, p, degree );
+            base = gf2_mulmod( base, base, p, degree );
+            exponent >>= 1;
+        }
+        return result;
+    }
+
+    std::vector<uint64_t> prime_factors( uint64_t value ) {
+        std::vector<uint64_t> factors;
+        for ( uint64_t d = 2; d * d <= value; ++d ) {
+            if ( value % d ) continue;
+            factors.push_back( d );
+            while ( value % d == 0 ) value /= d;
+        }
+        if ( value > 1 ) factors.push_back( value );
+        return factors;
+    }
+
+    // p is primitive iff x has order exactly 2^degree - 1 modulo p
+    bool is_primitive( uint64_t p, size_t degree, uint64_t order, const std::vector<uint64_t>& factors ) {
+        if ( !( p & 1 ) ) return false;
+        if ( degree > 1 && !( __builtin_popcountll( p ) & 1 ) ) return false;
+        if ( gf2_powmod_x( order, p, degree ) != 1 ) return false;
+        for ( uint64_t q : factors ) {
+            if ( gf2_powmod_x( order / q, p, degree ) == 1 ) return false;
+        }
+        return true;
+    }
+
+    BinPolynom from_mask( uint64_t p, size_t degree ) {
+        BinPolynom::coefficients_t coefficients( degree + 1 );
+        for ( size_t i = 0; i <= degree; ++i ) coefficients[ i ] = ( p >> i ) & 1;
+        return BinPolynom( std::move( coefficients ) );
+    }
+
+    void check_degree( size_t degree ) {
+        if ( degree == 0 || degree > MAX_PRIMITIVE_DEGREE ) {
+            throw std::runtime_error( "Primitive polynom degree must be in [1, 32]" );
+        }
+    }
+
+    uint64_t low_bits( uint64_t value, size_t count ) {
+        return count < 64 ? value & ( ( uint64_t( 1 ) << count ) - 1 ) : value;
+    }
+}
+
+BlockView::Block::Block( std::span<const std::byte> data, size_t bit, size_t bits )
+    : data_( data )
+    , bit_( bit )
+    , bits_( bits )
+{
+}
+
+uint64_t BlockView::Block::read( size_t offset, size_t count ) const
+{
+    if ( !count ) return 0;
+    size_t bit = bit_ + offset;
+    size_t first = bit >> 3;
+    size_t shift = bit & 7;
+    uint64_t value = 0;
+    if ( std::endian::native == std::endian::little && first + 8 <= data_.size() ) {
+        std::memcpy( &value, data_.data() + first, 8 );
+        value >>= shift;
+        if ( shift + count > 64 && first + 8 < data_.size() ) {
+            value |= std::to_integer<uint64_t>( data_[ first + 8 ] ) << ( 64 - shift );
+        }
+        return low_bits( value, count );
+    }
+
+    size_t last = std::min( ( bit + count + 7 ) >> 3, data_.size() );
+    for ( size_t i = first; i < last; ++i ) {
+        uint64_t byte_value = std::to_integer<uint64_t>( data_[ i ] );
+        value |= i == first ? byte_value >> shift : byte_value << ( ( i - first ) * 8 - shift );
+    }
+    return low_bits( value, count );
+}
+
+bool BlockView::Block::operator[]( size_t index ) const
+{
+    size_t bit = bit_ + index;
+    return ( bit >> 3 ) < data_.size() && ( std::to_integer<unsigned>( data_[ bit >> 3 ] ) >> ( bit & 7 ) ) & 1;
+}
+
+BinPolynom BlockView::Block::to_polynom() const
+{
+    BinPolynom::coefficients_t coefficients( bits_ );
+    for ( size_t i = 0; i < bits_; i += 64 ) {
+        size_t count = std::min<size_t>( 64, bits_ - i );
+        uint64_t word = read( i, count );
+        for ( size_t j = 0; j < count; ++j ) coefficients[ i + j ] = ( word >> j ) & 1;
+    }
+    return BinPolynom( std::move( coefficients ) );
+}
+
+BlockView::BlockView( std::span<const std::byte> data, size_t bits_per_block )
+    : data_( data )
+    , bits_per_block_( bits_per_block )
+{
+}
+
+size_t BlockView::size() const
+{
+    return bits_per_block_ ? ( data_.size() * 8 + bits_per_block_ - 1 ) / bits_per_block_ : 0;
+}
+
+BlockView::Block BlockView::operator[]( size_t index ) const
+{
+    size_t bit = index * bits_per_block_;
+    return Block( data_, bit, std::min( bits_per_block_, data_.size() * 8 - bit ) );
+}
+
+BitWriter::BitWriter( std::span<std::byte> out )
+    : out_( out )
+{
+}
+
+BitWriter::BitWriter( sink_t sink, size_t buffer_size )
+    : sink_( std::move( sink ) )
+    , buffer_( std::max<size_t>( buffer_size, 8 ) )
+{
+}
+
+void BitWriter::emit( const std::byte* data, size_t size )
+{
+    if ( !size ) return;
+    written_ += size;
+    if ( !sink_ ) {
+        if ( pos_ + size > out_.size() ) {
+            throw std::runtime_error( "BitWriter output is too small" );
+        }
+        std::memcpy( out_.data() + pos_, data, size );
+        pos_ += size;
         return;
     }
-    for ( size_t i = minimal_degree; i + to_remove.degree() <= degree && i < degree; ++i ) {
-        for ( size_t p = ( i == minimal_degree ? last_polynom_num : 0 ); p < primitive_polynoms[ i ].size(); ++p ) {
-            remove_non_primitive_polynoms( primitive_polynoms,
-                                           polynoms_of_degree,
-                                           degree,
-                                           i,
-                                           p,
-                                           to_remove*primitive_polynoms[ i ][ p ] );
+
+    while ( size ) {
+        size_t take = std::min( size, buffer_.size() - pos_ );
+        std::memcpy( buffer_.data() + pos_, data, take );
+        pos_ += take;
+        data += take;
+        size -= take;
+        if ( pos_ == buffer_.size() ) {
+            sink_( std::span<const std::byte>( buffer_.data(), pos_ ) );
+            pos_ = 0;
         }
     }
 }
 
+// Bits gather in a 64-bit accumulator, whole words go out at once
+void BitWriter::write( uint64_t value, size_t count )
+{
+    if ( !count ) return;
+    value = low_bits( value, count );
+    bits_ += count;
+    acc_ |= value << acc_bits_;
+    size_t total = acc_bits_ + count;
+    if ( total >= 64 ) {
+        std::byte word[ 8 ];
+        for ( size_t i = 0; i < 8; ++i ) word[ i ] = std::byte( acc_ >> ( i * 8 ) );
+        emit( word, 8 );
+        acc_ = acc_bits_ ? value >> ( 64 - acc_bits_ ) : 0;
+        total -= 64;
+    }
+    acc_bits_ = total;
+}
+
+void BitWriter::write( const BinPolynom& polynom, size_t bits )
+{
+    const BinPolynom::coefficients_t& coefficients = polynom.coefficients();
+    for ( size_t i = 0; i < bits; i += 64 ) {
+        size_t count = std::min<size_t>( 64, bits - i );
+        uint64_t word = 0;
+        for ( size_t j = 0; j < count && i + j < coefficients.size(); ++j ) word |= uint64_t( coefficients[ i + j ] ) << j;
+        write( word, count );
+    }
+}
+
+size_t BitWriter::flush()
+{
+    std::byte tail[ 8 ];
+    size_t tail_size = ( acc_bits_ + 7 ) / 8;
+    for ( size_t i = 0; i < tail_size; ++i ) tail[ i ] = std::byte( acc_ >> ( i * 8 ) );
+    emit( tail, tail_size );
+    acc_ = 0;
+    acc_bits_ = 0;
+    if ( sink_ && pos_ ) {
+        sink_( std::span<const std::byte>( buffer_.data(), pos_ ) );
+        pos_ = 0;
+    }
+    return written_;
+}
+
 std::vector<BinPolynom> Utilities::get_primitive_polynoms_with_degree( size_t degree ) {
-    std::vector< std::vector<BinPolynom> > primitive_polynoms_with_degree( degree + 1 );
-    primitive_polynoms_with_degree[ 1 ].push_back( { 1, 1 } ), primitive_polynoms_with_degree[ 1 ].push_back( { 0, 1 } );
-
-    for ( size_t i = 2; i <= degree; ++i ) {
-        size_t max_mask = 1 << ( i - 1 );
-        std::set<BinPolynom> polynoms;
-        BinPolynom::coefficients_t polynom_coefs( i + 1, 1 );
-        for ( size_t j = 0; j < max_mask; ++j ) {
-            for ( size_t t = 0; t <= i - 2; ++t ) {
-                polynom_coefs[ 1 + t ] = bool(j & ( 1 << t ));
-            }
-            polynoms.insert( polynom_coefs );
-        }
-        remove_non_primitive_polynoms( primitive_polynoms_with_degree, polynoms, i, 1 );
-        primitive_polynoms_with_degree[ i ].insert( primitive_polynoms_with_degree[ i ].end(), polynoms.begin(), polynoms.end() );
+    std::vector<BinPolynom> primitive_polynoms;
+    for_each_primitive_polynom( degree, [ &primitive_polynoms ]( const BinPolynom& polynom ) {
+        primitive_polynoms.push_back( polynom );
+        return true;
+    } );
+    return primitive_polynoms;
+}
+
+void Utilities::for_each_primitive_polynom( size_t degree, const std::function<bool( const BinPolynom& )>& callback ) {
+    check_degree( degree );
+    uint64_t order = ( uint64_t( 1 ) << degree ) - 1;
+    std::vector<uint64_t> factors = prime_factors( order );
+    uint64_t first = ( uint64_t( 1 ) << degree ) | 1;
+    uint64_t last = ( uint64_t( 1 ) << ( degree + 1 ) ) - 1;
+    for ( uint64_t p = first; p <= last; p += 2 ) {
+        if ( is_primitive( p, degree, order, factors ) && !callback( from_mask( p, degree ) ) ) return;
     }
-    return primitive_polynoms_with_degree[ degree ];
+}
+
+BinPolynom Utilities::find_primitive_polynom( size_t degree ) {
+    check_degree( degree );
+    uint64_t order = ( uint64_t( 1 ) << degree ) - 1;
+    std::vector<uint64_t> factors = prime_factors( order );
+    uint64_t first = ( uint64_t( 1 ) << degree ) | 1;
+    uint64_t last = ( uint64_t( 1 ) << ( degree + 1 ) ) - 1;
+
+    size_t threads_qty = degree < PARALLEL_SEARCH_DEGREE ? 1 : std::max( 1u, std::thread::hardware_concurrency() );
+    std::atomic<uint64_t> best( last + 2 );
+    auto search = [ & ]( size_t thread_num ) {
+        for ( uint64_t p = first + 2 * thread_num; p <= last && p < best.load( std::memory_order_relaxed ); p += 2 * threads_qty ) {
+            if ( !is_primitive( p, degree, order, factors ) ) continue;
+            uint64_t current = best.load();
+            while ( p < current && !best.compare_exchange_weak( current, p ) );
+            return;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for ( size_t i = 1; i < threads_qty; ++i ) workers.emplace_back( search, i );
+    search( 0 );
+    for ( auto& worker : workers ) worker.join();
+
+    assert( best.load() <= last );
+    return from_mask( best.load(), degree );
 }
 
 std::string Utilities::to_string( const bytes & bytes_array )
@@ -50,23 +278,15 @@ bytes Utilities::from_string( const std::string & str )
 
 bytes Utilities::concat_binary_polynoms( const std::vector<BinPolynom>& binary_polynoms, size_t bits_per_polynom )
 {
-    bytes result_bytes_array;
-    byte byte_helper = 0;;
-    for ( size_t i = 0, t = 0; i < binary_polynoms.size(); ++i ) {
-        BinPolynom::coefficients_t polynom_coefs = binary_polynoms[ i ].get_coefficients();
-        for ( size_t j = 0; j < bits_per_polynom; ++j, ++t ) {
-            if ( t == 8 ) {
-                result_bytes_array.push_back( byte_helper );
-                byte_helper = 0;
-                t = 0;
-            }
-            if ( j < polynom_coefs.size() ) {
-                byte_helper |= (byte)polynom_coefs[ j ] << t;
-            }
-        }
+    bytes result_bytes_array( ( binary_polynoms.size() * bits_per_polynom + 7 ) / 8 );
+    BitWriter writer( std::as_writable_bytes( std::span( result_bytes_array ) ) );
+    for ( const BinPolynom& polynom : binary_polynoms ) {
+        writer.write( polynom, bits_per_polynom );
     }
-    if ( byte_helper ) {
-        result_bytes_array.push_back( byte_helper );
+    writer.flush();
+    // The last byte is only kept when it is not zero
+    if ( !result_bytes_array.empty() && !result_bytes_array.back() ) {
+        result_bytes_array.pop_back();
     }
     return result_bytes_array;
 }
@@ -98,18 +318,11 @@ bytes Utilities::remove_zero_bytes_from_end(const bytes& bytes_array)
 
 std::vector<BinPolynom> Utilities::split_to_binary_polynoms( const bytes & bytes_array, size_t bits_per_polynom )
 {
+    BlockView view( std::as_bytes( std::span( bytes_array ) ), bits_per_polynom );
     std::vector<BinPolynom> binPolynoms;
-    BinPolynom::coefficients_t coefficients;
-    size_t bits_qty = bytes_array.size() << 3;
-    for ( size_t i = 0; i < bits_qty; ++i ) {
-        coefficients.push_back(bool( bytes_array[ i >> 3 ] & ( 1 << ( i & 7 ) ) ));
-        if ( coefficients.size() == bits_per_polynom ) {
-            binPolynoms.push_back( coefficients );
-            coefficients.clear();
-        }
-    }
-    if ( !coefficients.empty() ) {
-        binPolynoms.push_back( coefficients );
+    binPolynoms.reserve( view.size() );
+    for ( const BlockView::Block& block : view ) {
+        binPolynoms.push_back( block.to_polynom() );
     }
     return binPolynoms;
 }
@@ -0,0 +1,70 @@
+#include <ecc.h>
+#include <BCH.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace {
+
+// Building a code costs field tables and a generator, keep every (m, t) asked for.
+Coding::BCH& code( int m, int t )
+{
+    static std::mutex lock;
+    static std::map<std::pair<int, int>, std::unique_ptr<Coding::BCH>> codes;
+    std::lock_guard<std::mutex> guard( lock );
+    auto& slot = codes[ { m, t } ];
+    if ( !slot ) slot = std::make_unique<Coding::BCH>( m, 2 * t + 1 );
+    return *slot;
+}
+
+// Designed distance 2t + 1 must fit in the block, Coding::BCH throws otherwise.
+int supports( int m, int t )
+{
+    if ( m < 3 || m > 20 || t < 1 || size_t( 2 * t + 1 ) > ( size_t( 1 ) << m ) - 1 ) return 0;
+    return ( size_t( 1 ) << m ) - 1 > Coding::BCH::parity_bits( m, 2 * t + 1 );
+}
+
+long encoded_size( long size, int m, int t )
+{
+    return long( code( m, t ).encoded_size( size_t( size ) ) );
+}
+
+long decoded_size( long size, int m, int t )
+{
+    return long( code( m, t ).decoded_size( size_t( size ) ) );
+}
+
+// Coding::BCH drops trailing zero bytes of its output, callers go by the size they recorded.
+long encode( const byte_t* in, long size, byte_t* out, int m, int t )
+{
+    try {
+        Coding::BCH& bch = code( m, t );
+        auto src = std::as_bytes( std::span( in, size_t( size ) ) );
+        auto dst = std::as_writable_bytes( std::span( out, bch.encoded_size( size_t( size ) ) ) );
+        return long( bch.encode( src, dst ) );
+    }
+    catch ( const std::exception& ) {
+        return -1;
+    }
+}
+
+long decode( const byte_t* in, long size, byte_t* out, int m, int t )
+{
+    try {
+        Coding::BCH& bch = code( m, t );
+        auto src = std::as_bytes( std::span( in, size_t( size ) ) );
+        auto dst = std::as_writable_bytes( std::span( out, bch.decoded_size( size_t( size ) ) ) );
+        return long( bch.decode( src, dst ) );
+    }
+    catch ( const std::exception& ) {
+        return -1;
+    }
+}
+
+}
+
+extern "C" const ecc_backend_t ecc_bch_cpp_backend = {
+    "bch-cpp", HAMM_CODEC_BCH, HAMM_FLAG_BCH, ECC_CAP_PARALLEL | ECC_CAP_ANY_CODE, 20.0,
+    supports, encoded_size, decoded_size, encode, decode
+};
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ecc.h>
+#include <dio.h>
+
+#define ENCODE_CMD   "encode"
+#define DECODE_CMD   "decode"
+#define LIST_CMD     "list"
+#define SUPPORTS_CMD "supports"
+
+#define CODE_ARG        "--code"
+#define M_ARG           "--m"
+#define PARITY_BITS_ARG "--pb"
+#define T_ARG           "--t"
+#define BACKEND_ARG     "--backend"
+#define TARGET_ARG      "--target"
+#define OUTPUT_ARG      "--out"
+
+static int _codec = HAMM_CODEC_HAMMING;
+static int _m = 0;
+static int _t = 0;
+static const char* _backend  = NULL;
+static const char* _target   = "input.bin";
+static const char* _out_path = "output.ecc";
+
+static const char* _codec_name(int codec) {
+    return codec == HAMM_CODEC_HAMMING ? "hamming" : codec == HAMM_CODEC_BCH ? "bch" : "none";
+}
+
+static double _now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int _list() {
+    const ecc_backend_t* backend;
+    for (int i = 0; (backend = ecc_backend_at(i)); i++) {
+        fprintf(stdout, "%-12s %-8s format=0x%02x throughput=%6.0f MB/s%s%s%s\n", backend->name, _codec_name(backend->codec),
+                backend->format, backend->throughput, backend->caps & ECC_CAP_PARALLEL ? " parallel" : "",
+                backend->caps & ECC_CAP_SIMD ? " simd" : "", backend->caps & ECC_CAP_ANY_CODE ? " any-code" : "");
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+--backend wins when it can code (m, t) in the required format, otherwise the fastest registered backend is used.
+*/
+static const ecc_backend_t* _select(int codec, int format, int m, int t) {
+    if (!_backend) {
+        const ecc_backend_t* backend = ecc_pick(codec, format, m, t);
+        if (!backend) fprintf(stderr, "[ecc] no backend for %s m=%i, t=%i\n", _codec_name(codec), m, t);
+        return backend;
+    }
+
+    const ecc_backend_t* backend = ecc_backend(_backend);
+    if (!backend) fprintf(stderr, "[ecc] unknown backend %s, see ecc list\n", _backend);
+    else if (backend->codec != codec || (format >= 0 && backend->format != format) || !backend->supports(m, t)) {
+        fprintf(stderr, "[ecc] backend %s cannot code %s m=%i, t=%i", _backend, _codec_name(codec), m, t);
+        if (format >= 0) fprintf(stderr, " in format 0x%02x", format);
+        fprintf(stderr, "\n");
+        backend = NULL;
+    }
+
+    return backend;
+}
+
+/*
+Exit status only: 0 when --backend (or any backend without it) codes --code / --m / --t.
+*/
+static int _supports() {
+    if (!_m) _m = _codec == HAMM_CODEC_BCH ? 15 : 4;
+    if (!_t) _t = _codec == HAMM_CODEC_BCH ? 3 : 1;
+    return _select(_codec, -1, _m, _t) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static byte_t* _read_all(const char* path, long* size) {
+    dio_file_t f;
+    if (!dio_open(&f, path, DIO_READ, 0)) return NULL;
+    byte_t* data = (byte_t*)malloc(MAX((long)f.size, 1));
+    long got = data ? dio_read(&f, data, (long)f.size) : -1;
+    dio_close(&f);
+    if (got < 0) {
+        free(data);
+        return NULL;
+    }
+
+    *size = got;
+    return data;
+}
+
+static int _report(const ecc_backend_t* backend, long in_size, long out_size, double seconds) {
+    fprintf(stdout, "[ecc] backend=%s, in=%ld, out=%ld, %.1f MB/s\n", backend->name, in_size, out_size, in_size / 1e6 / MAX(seconds, 1e-9));
+    return EXIT_SUCCESS;
+}
+
+/*
+Output starts with a hamm_header_t: the backend format in flags, m, t in reserved and the input size.
+*/
+static int _encode() {
+    if (!_m) _m = _codec == HAMM_CODEC_BCH ? 15 : 4;
+    if (!_t) _t = _codec == HAMM_CODEC_BCH ? 3 : 1;
+    const ecc_backend_t* backend = _select(_codec, -1, _m, _t);
+    if (!backend) return EXIT_FAILURE;
+
+    long in_size = 0;
+    byte_t* in = _read_all(_target, &in_size);
+    if (!in) return EXIT_FAILURE;
+
+    long bound = backend->encoded_size(in_size, _m, _t);
+    byte_t* out = bound >= 0 ? (byte_t*)calloc(MAX(bound, 1), 1) : NULL;
+    double start = _now();
+    long out_size = out ? backend->encode(in, in_size, out, _m, _t) : -1;
+    double seconds = _now() - start;
+    free(in);
+    if (out_size < 0) {
+        fprintf(stderr, "[ecc] %s failed to encode %s\n", backend->name, _target);
+        free(out);
+        return EXIT_FAILURE;
+    }
+
+    hamm_header_t header = { .magic = HAMM_MAGIC, .m = _m, .flags = backend->format, .reserved = _t, .size = in_size };
+    dio_file_t fo;
+    int res = EXIT_FAILURE;
+    if (dio_open(&fo, _out_path, DIO_WRITE, 0)) {
+        int written = dio_write(&fo, &header, sizeof(header)) >= 0 && dio_write(&fo, out, out_size) >= 0;
+        if (dio_close(&fo) && written) res = _report(backend, in_size, out_size + (long)sizeof(header), seconds);
+    }
+
+    if (res != EXIT_SUCCESS) fprintf(stderr, "[ecc] cannot write %s\n", _out_path);
+
+    free(out);
+    return res;
+}
+
+/*
+The header picks code and format. Files without one (file2hamm / old file2bch output)
+are decoded with --code / --m / --t and written out whole.
+*/
+static int _decode() {
+    long in_size = 0;
+    byte_t* in = _read_all(_target, &in_size);
+    if (!in) return EXIT_FAILURE;
+
+    hamm_header_t header = { 0 };
+    if (in_size >= (long)sizeof(header)) memcpy(&header, in, sizeof(header));
+    int framed = header.magic == HAMM_MAGIC;
+    int format = 0;
+    long skip = 0;
+    if (framed) {
+        if (header.flags & ~(HAMM_FLAG_BCH | HAMM_FLAG_BCH_C)) {
+            fprintf(stderr, "[ecc] %s uses a hamm2file layout (flags=%i)\n", _target, header.flags);
+            free(in);
+            return EXIT_FAILURE;
+        }
+
+        format = header.flags;
+        _codec = format ? HAMM_CODEC_BCH : HAMM_CODEC_HAMMING;
+        _m = header.m;
+        _t = format ? header.reserved : 1;
+        skip = sizeof(header);
+    }
+    else {
+        if (!_m) _m = _codec == HAMM_CODEC_BCH ? 15 : 4;
+        if (!_t) _t = _codec == HAMM_CODEC_BCH ? 3 : 1;
+        format = _codec == HAMM_CODEC_BCH ? HAMM_FLAG_BCH : 0;
+    }
+
+    const ecc_backend_t* backend = _select(_codec, format, _m, _t);
+    if (!backend) {
+        free(in);
+        return EXIT_FAILURE;
+    }
+
+    long body_size = in_size - skip;
+    long bound = backend->decoded_size(body_size, _m, _t);
+    if (framed) bound = MAX(bound, (long)header.size);
+    byte_t* out = bound >= 0 ? (byte_t*)calloc(MAX(bound, 1), 1) : NULL;
+    double start = _now();
+    long out_size = out ? backend->decode(in + skip, body_size, out, _m, _t) : -1;
+    double seconds = _now() - start;
+    free(in);
+    if (out_size < 0) {
+        fprintf(stderr, "[ecc] %s failed to decode %s\n", backend->name, _target);
+        free(out);
+        return EXIT_FAILURE;
+    }
+
+    /* Trailing zero bytes the codec left out are already zero in out. */
+    if (framed) out_size = (long)header.size;
+
+    dio_file_t fo;
+    int res = EXIT_FAILURE;
+    if (dio_open(&fo, _out_path, DIO_WRITE, 0)) {
+        int written = dio_write(&fo, out, out_size) >= 0;
+        if (dio_close(&fo) && written) res = _report(backend, body_size, out_size, seconds);
+    }
+
+    if (res != EXIT_SUCCESS) fprintf(stderr, "[ecc] cannot write %s\n", _out_path);
+
+    free(out);
+    return res;
+}
+
+/*
+ecc encode|decode|list|supports [options]
+--code - hamming (default) or bch
+--m (or --pb) - Parity bits count / field degree (default 4 for hamming, 15 for bch)
+--t - Correctable errors per block for bch (default 3)
+--backend - Force a backend (see ecc list), the fastest one that supports the code otherwise
+--target - Target file
+--out - Path to save location (will create new file)
+*/
+int main(int argc, char* argv[]) {
+    const char* cmd = argc > 1 ? argv[1] : LIST_CMD;
+    for (int i = 2; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!strcmp(argv[i], CODE_ARG) && value) {
+            if (!strcmp(value, "hamming")) _codec = HAMM_CODEC_HAMMING;
+            else if (!strcmp(value, "bch")) _codec = HAMM_CODEC_BCH;
+            else {
+                fprintf(stderr, "Unknown code %s!\n", value);
+                return EXIT_FAILURE;
+            }
+        }
+        else if ((!strcmp(argv[i], M_ARG) || !strcmp(argv[i], PARITY_BITS_ARG)) && value) _m = atoi(value);
+        else if (!strcmp(argv[i], T_ARG) && value) _t = atoi(value);
+        else if (!strcmp(argv[i], BACKEND_ARG) && value) _backend = value;
+        else if (!strcmp(argv[i], TARGET_ARG) && value) _target = value;
+        else if (!strcmp(argv[i], OUTPUT_ARG) && value) _out_path = value;
+        else {
+            fprintf(stderr, "Unknown arg %s or missing value!\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+
+        i++;
+    }
+
+    ll_init();
+    if (!strcmp(cmd, ENCODE_CMD)) return _encode();
+    if (!strcmp(cmd, DECODE_CMD)) return _decode();
+    if (!strcmp(cmd, LIST_CMD)) return _list();
+    if (!strcmp(cmd, SUPPORTS_CMD)) return _supports();
+    fprintf(stderr, "Unknown command %s, expected encode, decode, list or supports!\n", cmd);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,90 @@
+#include <adapt.h>
+#include <bch.h>
+
+static double _pow_int(double x, long e) {
+    double r = 1.0;
+    while (e) {
+        if (e & 1) r *= x;
+        x *= x;
+        e >>= 1;
+    }
+
+    return r;
+}
+
+/*
+Binomial terms are walked with P(i + 1) = P(i) * (n - i) / (i + 1) * p / (1 - p)
+from P(0) = (1 - p)^n. When P(0) underflows the code is far past its
+correcting power and decoding is assumed to change nothing.
+*/
+double hamm_residual_ber(long n, int t, double ber) {
+    if (ber <= 0.0) return 0.0;
+    if (ber >= 0.5 || t <= 0) return ber;
+
+    double term = _pow_int(1.0 - ber, n);
+    if (term <= 0.0) return ber;
+
+    double ratio = ber / (1.0 - ber);
+    double residual = 0.0;
+    for (long i = 0; i < n; i++) {
+        term *= (double)(n - i) / (double)(i + 1) * ratio;
+        if (i + 1 <= t) continue;
+
+        long wrong = i + 1 + t < n ? i + 1 + t : n;
+        double add = term * (double)wrong / (double)n;
+        residual += add;
+        if (i + 1 > n * ber && add < residual * 1e-12) break;
+    }
+
+    return residual < ber ? residual : ber;
+}
+
+static void _consider(hamm_code_t* best, int* met, double target, int codec, int m, int t, long n, long k, double ber) {
+    if (k <= 0) return;
+    double residual = hamm_residual_ber(n, t, ber);
+    int ok = residual <= target;
+
+    int take = 0;
+    if (ok != *met) take = ok;
+    else if (ok) take = (double)n * best->k < (double)best->n * k * (1.0 - 1e-12); /* ties keep the earlier (cheaper) codec */
+    else take = residual < best->residual;
+    if (!take) return;
+
+    *met = ok;
+    best->codec = codec;
+    best->m = m;
+    best->t = t;
+    best->n = n;
+    best->k = k;
+    best->residual = residual;
+}
+
+int hamm_select_code(double ber, double target, int candidates, hamm_code_t* code) {
+    int met = 0;
+    hamm_code_t best = { .codec = HAMM_CODEC_NONE, .m = 0, .t = 0, .n = 1, .k = 1, .residual = ber > 0.0 ? ber : 0.0 };
+    met = best.residual <= target;
+
+    if (candidates & HAMM_SELECT_HAMMING) {
+        for (int m = HAMM_SELECT_MAX_M; m >= 2; m--) {
+            long n = (1L << m) - 1;
+            _consider(&best, &met, target, HAMM_CODEC_HAMMING, m, 1, n, n - m, ber);
+        }
+    }
+
+    if (candidates & HAMM_SELECT_BCH) {
+        _consider(&best, &met, target, HAMM_CODEC_BCH, BCH_M, BCH_T, BCH_N, BCH_K, ber);
+    }
+
+    if (candidates & HAMM_SELECT_BCH_ANY) {
+        for (int m = 3; m <= 16; m++) {
+            long n = (1L << m) - 1;
+            for (int t = 1; t <= HAMM_SELECT_MAX_T && (long)m * t < n; t++) {
+                _consider(&best, &met, target, HAMM_CODEC_BCH, m, t, n, n - (long)m * t, ber);
+                if (hamm_residual_ber(n, t, ber) <= target) break;
+            }
+        }
+    }
+
+    *code = best;
+    return met;
+}
@@ -0,0 +1,205 @@
+#include <container.h>
+#include <crc32c.h>
+#include <bch.h>
+
+/* Re-encode window used to count corrected bits, holds at least one 8-block group for every supported m. */
+#define HAMM_CHUNK_SCRATCH 16384
+
+static int _supported(int codec, int m, int t) {
+    switch (codec) {
+        case HAMM_CODEC_NONE:    return 1;
+        case HAMM_CODEC_HAMMING: return m >= 2 && m <= HAMM_SELECT_MAX_M;
+        case HAMM_CODEC_BCH:     return m == BCH_M && t == BCH_T;
+    }
+
+    return 0;
+}
+
+/*
+Block geometry in bits. 8 blocks hold exactly k data bytes and n code bytes,
+which is the granularity chunks are re-encoded at.
+*/
+static void _geometry(int codec, int m, long* n, long* k) {
+    if (codec == HAMM_CODEC_BCH) {
+        *n = BCH_N;
+        *k = BCH_K;
+    }
+    else {
+        *n = (1L << m) - 1;
+        *k = *n - m;
+    }
+}
+
+static long _encode(int codec, int m, const byte_t* in, long size, byte_t* out) {
+    switch (codec) {
+        case HAMM_CODEC_NONE:
+            str_memcpy(out, in, size);
+            return size;
+        case HAMM_CODEC_HAMMING:
+            return encode_hamming_array(in, size, out, m);
+        case HAMM_CODEC_BCH:
+            bch_init();
+            return encode_bch(in, size, out);
+    }
+
+    return -1;
+}
+
+/* Encoded bytes in front of the CRC. */
+static long _payload(const hamm_chunk_t* chunk) {
+    return chunk->flags & HAMM_CHUNK_CRC ? (long)chunk->enc_size - (long)sizeof(unsigned int) : (long)chunk->enc_size;
+}
+
+/*
+Header checks before the body is touched: an unstored (NONE) chunk
+is copied as is, its size can't exceed the stored payload.
+*/
+static int _valid(const hamm_chunk_t* chunk) {
+    if (!_supported(chunk->codec, chunk->m, chunk->t) || _payload(chunk) < 0) return 0;
+    return chunk->codec != HAMM_CODEC_NONE || (long)chunk->size <= _payload(chunk);
+}
+
+long hamm_chunk_bound(long size, const hamm_code_t* code, int flags) {
+    if (!_supported(code->codec, code->m, code->t)) return -1;
+    long crc = flags & HAMM_CHUNK_CRC ? sizeof(unsigned int) : 0;
+    switch (code->codec) {
+        case HAMM_CODEC_HAMMING: return calculate_encoded_size(size, code->m) + crc;
+        case HAMM_CODEC_BCH:     return bch_encoded_size(size) + crc;
+    }
+
+    return size + crc;
+}
+
+long hamm_chunk_decoded_bound(const hamm_chunk_t* chunk) {
+    if (!_valid(chunk)) return -1;
+    switch (chunk->codec) {
+        case HAMM_CODEC_HAMMING: return MAX((long)chunk->size, calculate_decoded_size(_payload(chunk), chunk->m));
+        case HAMM_CODEC_BCH:     return MAX((long)chunk->size, (long)bch_decoded_size(_payload(chunk)));
+    }
+
+    return chunk->size;
+}
+
+long hamm_chunk_encode(const byte_t* in, long size, const hamm_code_t* code, int flags, hamm_chunk_t* chunk, byte_t* out) {
+    if (!_supported(code->codec, code->m, code->t)) return -1;
+    long enc_size = _encode(code->codec, code->m, in, size, out);
+    if (enc_size < 0) return -1;
+
+    /* The CRC goes last, so the codeword bytes keep the alignment of the caller buffer. */
+    if (flags & HAMM_CHUNK_CRC) {
+        unsigned int crc = crc32c(0, in, size);
+        str_memcpy(out + enc_size, &crc, sizeof(crc));
+        enc_size += sizeof(crc);
+    }
+
+    chunk->codec = code->codec;
+    chunk->m = code->m;
+    chunk->t = code->t;
+    chunk->flags = flags & HAMM_CHUNK_CRC;
+    chunk->size = size;
+    chunk->enc_size = enc_size;
+    return enc_size;
+}
+
+static long _count_corrected(const hamm_chunk_t* chunk, const byte_t* body, const byte_t* data) {
+    byte_t scratch[HAMM_CHUNK_SCRATCH];
+    long n, k;
+    _geometry(chunk->codec, chunk->m, &n, &k);
+
+    long step = HAMM_CHUNK_SCRATCH / n * k;
+    long corrected = 0;
+    for (long off = 0; off < chunk->size; off += step) {
+        long len = MIN(step, chunk->size - off);
+        long out = _encode(chunk->codec, chunk->m, data + off, len, scratch);
+        const byte_t* rx = body + off / k * n;
+        for (long i = 0; i < out && off / k * n + i < _payload(chunk); i++) {
+            corrected += __builtin_popcount(scratch[i] ^ rx[i]);
+        }
+    }
+
+    return corrected;
+}
+
+/* Data bit of codeword position p (1-based, parity at powers of two), -1 for parity. */
+static long _data_bit(long p) {
+    return p & (p - 1) ? p - 2 - (31 - __builtin_clz((unsigned int)p)) : -1;
+}
+
+/* CRC change of flipping codeword position p of block b, 0 for parity and padding. */
+static unsigned int _flip_crc(long b, long p, long k, long size) {
+    long bit = _data_bit(p);
+    if (bit < 0 || b * k + bit >= size * 8) return 0;
+    return crc32c_bit(b * k + bit, size);
+}
+
+/*
+A block with two errors has a non-zero syndrome s, the decoder flipped
+position s and left three wrong bits. The real pair is one of the (n - 1) / 2
+pairs (i, i ^ s), so every corrected block gets those candidates tried against
+the CRC difference, one miscorrected block per chunk is undone this way.
+*/
+static int _recover_hamming(const hamm_chunk_t* chunk, const byte_t* body, byte_t* out, unsigned int diff) {
+    long n = (1L << chunk->m) - 1;
+    long k = n - chunk->m;
+    long blocks = _payload(chunk) * 8 / n;
+    long size = chunk->size;
+    long tried = 0;
+
+    for (long b = 0; b < blocks && b * k < size * 8; b++) {
+        long s = 0;
+        for (long i = 0; i < n; i += 64) {
+            int count = (int)MIN(64, n - i);
+            unsigned long long bits = get_bits_buff(body, b * n + i, count);
+            for (; bits; bits &= bits - 1) s ^= i + __builtin_ctzll(bits) + 1;
+        }
+
+        if (!s) continue;
+        unsigned int undo = _flip_crc(b, s, k, size);
+        for (long i = 1; i <= n; i++) {
+            long j = i ^ s;
+            if (j < i) continue;
+            if (++tried > HAMM_CHUNK_RECOVER_MAX) return 0;
+            if ((undo ^ _flip_crc(b, i, k, size) ^ _flip_crc(b, j, k, size)) != diff) continue;
+
+            long flips[3] = { s, i, j };
+            for (int f = 0; f < 3; f++) {
+                long bit = _data_bit(flips[f]);
+                if (bit >= 0 && b * k + bit < size * 8) out[(b * k + bit) / 8] ^= 1 << ((b * k + bit) % 8);
+            }
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+long hamm_chunk_decode(const hamm_chunk_t* chunk, const byte_t* body, byte_t* out, long* corrected, int* state) {
+    if (state) *state = HAMM_CHUNK_OK;
+    if (!_valid(chunk)) return -1;
+    switch (chunk->codec) {
+        case HAMM_CODEC_NONE:
+            str_memcpy(out, body, chunk->size);
+            break;
+        case HAMM_CODEC_HAMMING:
+            if (decode_hamming_array(body, _payload(chunk), out, chunk->m) < 0) return -1;
+            break;
+        case HAMM_CODEC_BCH:
+            bch_init();
+            decode_bch(body, _payload(chunk), out);
+            break;
+    }
+
+    if (chunk->flags & HAMM_CHUNK_CRC) {
+        unsigned int stored;
+        str_memcpy(&stored, body + _payload(chunk), sizeof(stored));
+        unsigned int diff = crc32c(0, out, chunk->size) ^ stored;
+        if (diff) {
+            int fixed = chunk->codec == HAMM_CODEC_HAMMING && _recover_hamming(chunk, body, out, diff);
+            if (state) *state = fixed ? HAMM_CHUNK_RECOVERED : HAMM_CHUNK_CORRUPT;
+        }
+    }
+
+    if (corrected) *corrected = chunk->codec == HAMM_CODEC_NONE ? 0 : _count_corrected(chunk, body, out);
+    return chunk->size;
+}
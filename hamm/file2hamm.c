@@ -2,66 +2,273 @@
 #include <string.h>
 #include <stdlib.h>
 #include <hamm/hamm.h>
+#include <hamm/container.h>
+#include <hamm/product.h>
+#include <pool.h>
+#include <hbuf.h>
+#include <dio.h>
 
 #define PARITY_BITS_ARG "--pb"
 #define TARGET_ARG      "--target"
 #define OUTPUT_ARG      "--out"
+#define ALIGNED_ARG     "--aligned"
+#define PRODUCT_ARG     "--product"
+#define ADAPTIVE_ARG    "--adaptive"
+#define BER_ARG         "--ber"
+#define TARGET_BER_ARG  "--target-ber"
+#define CHUNK_ARG       "--chunk"
+#define STATS_ARG       "--stats"
+#define CRC_ARG         "--crc"
+#define NUMA_ARG        "--numa"
+#define HUGE_ARG        "--huge"
+#define DIRECT_ARG      "--direct"
 
 static int _m = 4;
+static int _numa = 0;
+static int _huge = 0;
+static int _direct = 0;
+static int _aligned = 0;
+static int _product = 0;
+static int _adaptive = 0;
+static int _crc = 0;
+static double _ber = 1e-4;
+static double _target_ber = 1e-9;
+static long _chunk = HAMM_CHUNK_SIZE;
+static const char* _stats    = NULL;
 static const char* _target   = "image.img";
 static const char* _out_path = "image.hamm";
 
+/*
+Per-chunk channel BER from a hamm2file --stats dump ("<chunk> <corrected bits> <coded bits>" lines).
+Chunks without a measurement (or with none corrected) fall back to --ber.
+*/
+static double* _load_stats(long* count) {
+    *count = 0;
+    if (!_stats) return NULL;
+    FILE* f = fopen(_stats, "r");
+    if (!f) return NULL;
+
+    double* bers = NULL;
+    long index, corrected, bits;
+    while (fscanf(f, "%ld %ld %ld", &index, &corrected, &bits) == 3) {
+        if (index < 0 || bits <= 0) continue;
+        if (index >= *count) {
+            double* grown = (double*)realloc(bers, (index + 1) * sizeof(double));
+            if (!grown) break;
+            for (long i = *count; i <= index; i++) grown[i] = _ber;
+            bers = grown;
+            *count = index + 1;
+        }
+
+        bers[index] = MAX(_ber, (double)corrected / bits);
+    }
+
+    fclose(f);
+    return bers;
+}
+
+static int _encode_adaptive(dio_file_t* src_f, long in_size, dio_file_t* fo) {
+    long stats_count = 0;
+    double* bers = _load_stats(&stats_count);
+    hbuf_t chunk_buf = { 0 }, body_buf = { 0 };
+    if (!hbuf_alloc(&chunk_buf, _chunk, _huge) || !hbuf_alloc(&body_buf, calculate_encoded_size(_chunk, 2) + sizeof(unsigned int), _huge)) {
+        hbuf_free(&chunk_buf);
+        free(bers);
+        return EXIT_FAILURE;
+    }
+
+    byte_t* chunk = (byte_t*)chunk_buf.data;
+    byte_t* body = (byte_t*)body_buf.data;
+
+    hamm_header_t header = { .magic = HAMM_MAGIC, .m = 0, .flags = HAMM_FLAG_CHUNKED, .size = in_size };
+    int res = dio_write(fo, &header, sizeof(header)) < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+
+    long total = sizeof(header);
+    long index = 0;
+    for (long size; res == EXIT_SUCCESS && (size = dio_read(src_f, chunk, _chunk)) > 0; index++) {
+        hamm_code_t code;
+        double ber = index < stats_count ? bers[index] : _ber;
+        if (!hamm_select_code(ber, _target_ber, HAMM_SELECT_HAMMING | HAMM_SELECT_BCH, &code)) {
+            fprintf(stderr, "[file2hamm] chunk %ld: no code reaches %g at BER %g, using the strongest one\n", index, _target_ber, ber);
+        }
+
+        hamm_chunk_t info;
+        long enc_size = hamm_chunk_encode(chunk, size, &code, _crc, &info, body);
+        if (enc_size < 0) {
+            fprintf(stderr, "[file2hamm] chunk %ld: encoding failed\n", index);
+            res = EXIT_FAILURE;
+            break;
+        }
+
+        if (dio_write(fo, &info, sizeof(info)) < 0 || dio_write(fo, body, enc_size) < 0) res = EXIT_FAILURE;
+        total += sizeof(info) + enc_size;
+    }
+
+    fprintf(stdout, "[file2hamm] chunks=%ld, in=%ld, out=%ld\n", index, in_size, total);
+    hbuf_free(&chunk_buf);
+    hbuf_free(&body_buf);
+    free(bers);
+    return res;
+}
+
+/*
+Where the pages of a NUMA-placed buffer ended up and how many tasks crossed nodes.
+*/
+static void _numa_report(const void* buf, long size) {
+    pool_numa_stats_t stats;
+    if (!_numa) return;
+    int known = pool_numa_stats(buf, size, &stats);
+    fprintf(stdout, "[%s] numa nodes=%d, remote tasks=%ld/%ld", "file2hamm", stats.nodes, stats.remote_tasks, stats.tasks);
+    if (known) fprintf(stdout, ", remote pages=%ld/%ld\n", stats.remote_pages, stats.pages);
+    else fprintf(stdout, ", page placement unknown\n");
+}
+
 /*
 --pb - parity bits count (pb=0 => without encoding, just copy)
 --target - Target file for encoding
 --out - Path to save location (will create new file)
+--aligned - Byte-aligned codewords (see hamm_aligned_stride), stored with a hamm_header_t
+--product - 2D product code (rows and columns Hamming-encoded, see product.h), stored with a hamm_header_t
+--adaptive - Chunked container, the code of every chunk is picked by hamm_select_code
+--ber - Channel bit error rate estimate for --adaptive
+--target-ber - Acceptable residual bit error rate for --adaptive
+--chunk - Chunk size for --adaptive
+--stats - Per-chunk corrected bits dump from hamm2file --stats, refines --ber per chunk
+--crc - Store a CRC32C of every --adaptive chunk, hamm2file catches miscorrected chunks with it
+--numa - Pin pool workers over the NUMA nodes, first-touch buffers per worker slice and report placement
+--huge - Back the codec buffers with huge pages (hugetlbfs, then THP, then regular pages)
+--direct - O_DIRECT I/O, leaves the page cache alone (target and out may be block devices)
 */
 int main(int argc, char* argv[]) {
     if (argc > 1) {
         for (int i = 1; i < argc; i++) {
-            if (!strcmp(argv[i], PARITY_BITS_ARG)) _m = atoi(argv[i++ + 1]);
-            else if (!strcmp(argv[i], TARGET_ARG)) _target = argv[i++ + 1];
-            else if (!strcmp(argv[i], OUTPUT_ARG)) _out_path = argv[i++ + 1];
-            else fprintf(stderr, "Unknown arg %s!\n", argv[i]);
+            const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+            if (!strcmp(argv[i], PARITY_BITS_ARG) && value) _m = atoi(argv[++i]);
+            else if (!strcmp(argv[i], TARGET_ARG) && value) _target = argv[++i];
+            else if (!strcmp(argv[i], OUTPUT_ARG) && value) _out_path = argv[++i];
+            else if (!strcmp(argv[i], ALIGNED_ARG)) _aligned = 1;
+            else if (!strcmp(argv[i], PRODUCT_ARG)) _product = 1;
+            else if (!strcmp(argv[i], ADAPTIVE_ARG)) _adaptive = 1;
+            else if (!strcmp(argv[i], BER_ARG) && value) _ber = atof(argv[++i]);
+            else if (!strcmp(argv[i], TARGET_BER_ARG) && value) _target_ber = atof(argv[++i]);
+            else if (!strcmp(argv[i], CHUNK_ARG) && value) _chunk = atol(argv[++i]);
+            else if (!strcmp(argv[i], STATS_ARG) && value) _stats = argv[++i];
+            else if (!strcmp(argv[i], CRC_ARG)) _crc = HAMM_CHUNK_CRC;
+            else if (!strcmp(argv[i], NUMA_ARG)) _numa = 1;
+            else if (!strcmp(argv[i], HUGE_ARG)) _huge = HBUF_HUGE;
+            else if (!strcmp(argv[i], DIRECT_ARG)) _direct = DIO_DIRECT;
+            else {
+                fprintf(stderr, "Unknown arg %s or missing value!\n", argv[i]);
+                return EXIT_FAILURE;
+            }
         }
     }
 
-    fprintf(stdout, "[file2hamm] _target=%s, _out_path=%s, _m=%i\n", _target, _out_path, _m);
-    FILE* src_f = fopen(_target, "rb");
-    if (!src_f) return EXIT_FAILURE;
+    fprintf(stdout, "[file2hamm] _target=%s, _out_path=%s, _m=%i, _aligned=%i\n", _target, _out_path, _m, _aligned);
+    if (_numa) pool_numa(1);
+    dio_file_t src_f, fo;
+    if (!dio_open(&src_f, _target, DIO_READ, _direct)) return EXIT_FAILURE;
+    long in_size = (long)src_f.size;
+    if (_direct && !src_f.direct) fprintf(stderr, "[file2hamm] O_DIRECT not supported for %s, using cached I/O\n", _target);
 
-    fseek(src_f, 0, SEEK_END);
-    long in_size = ftell(src_f);
-    fseek(src_f, 0, SEEK_SET);
+    if (_adaptive) {
+        if (_chunk <= 0) _chunk = HAMM_CHUNK_SIZE;
+        if (_direct) _chunk = (_chunk + DIO_ALIGN - 1) / DIO_ALIGN * DIO_ALIGN;
+        if (!dio_open(&fo, _out_path, DIO_WRITE, _direct)) {
+            dio_close(&src_f);
+            return EXIT_FAILURE;
+        }
 
-    char* buffer = (char*)malloc(in_size);
-    if (!buffer) {
-        fclose(src_f);
+        ll_init();
+        int res = _encode_adaptive(&src_f, in_size, &fo);
+        dio_close(&src_f);
+        if (!dio_close(&fo)) res = EXIT_FAILURE;
+        if (res != EXIT_SUCCESS) fprintf(stderr, "[file2hamm] cannot write %s\n", _out_path);
+        return res;
+    }
+
+    hbuf_t in_buf;
+    if (!hbuf_alloc(&in_buf, in_size, _huge)) {
+        dio_close(&src_f);
         return EXIT_FAILURE;
     }
 
-    fread(buffer, 1, in_size, src_f);
-    fclose(src_f);
-    
-    FILE* fo = fopen(_out_path, "wb");
-    if (!fo) return EXIT_FAILURE;
+    char* buffer = (char*)in_buf.data;
+    if (_huge) fprintf(stdout, "[file2hamm] buffers=%s\n", hbuf_kind_name(in_buf.kind));
+
+    pool_touch(buffer, in_size);
+    long got = dio_read(&src_f, buffer, in_size);
+    in_size = MAX(got, 0);
+    dio_close(&src_f);
 
-    if (!_m) fwrite(buffer, 1, in_size, fo);
+    if (!dio_open(&fo, _out_path, DIO_WRITE, _direct)) {
+        hbuf_free(&in_buf);
+        return EXIT_FAILURE;
+    }
+
+    int written = 1;
+    if (!_m) written = dio_write(&fo, buffer, in_size) >= 0;
+    else if (_aligned) {
+        long enc_size = calculate_encoded_size_aligned(in_size, _m);
+        hbuf_t out_buf;
+        if (!hbuf_alloc(&out_buf, enc_size, _huge)) {
+            hbuf_free(&in_buf);
+            return EXIT_FAILURE;
+        }
+
+        char* encoded = (char*)out_buf.data;
+        if (encode_hamming_aligned((const byte_t*)buffer, in_size, (byte_t*)encoded, _m) < 0) {
+            fprintf(stderr, "Aligned layout supports --pb 2..9 only!\n");
+            hbuf_free(&out_buf);
+            hbuf_free(&in_buf);
+            return EXIT_FAILURE;
+        }
+
+        hamm_header_t header = { .magic = HAMM_MAGIC, .m = _m, .flags = HAMM_FLAG_ALIGNED, .size = in_size };
+        written = dio_write(&fo, &header, sizeof(header)) >= 0 && dio_write(&fo, encoded, enc_size) >= 0;
+        hbuf_free(&out_buf);
+    }
+    else if (_product) {
+        ll_init();
+        long enc_size = calculate_encoded_size_product(in_size, _m);
+        hbuf_t out_buf;
+        if (!hbuf_alloc(&out_buf, enc_size, _huge)) {
+            hbuf_free(&in_buf);
+            return EXIT_FAILURE;
+        }
+
+        char* encoded = (char*)out_buf.data;
+        if (encode_hamming_product((const byte_t*)buffer, in_size, (byte_t*)encoded, _m) < 0) {
+            fprintf(stderr, "Product code supports --pb 2..9 only!\n");
+            hbuf_free(&out_buf);
+            hbuf_free(&in_buf);
+            return EXIT_FAILURE;
+        }
+
+        hamm_header_t header = { .magic = HAMM_MAGIC, .m = _m, .flags = HAMM_FLAG_PRODUCT, .size = in_size };
+        written = dio_write(&fo, &header, sizeof(header)) >= 0 && dio_write(&fo, encoded, enc_size) >= 0;
+        hbuf_free(&out_buf);
+    }
     else {
         ll_init();
-        long enc_size = calculate_encoded_size((int)in_size, _m);
-        char* encoded = (char*)malloc(enc_size);
-        if (!encoded) {
-            free(buffer);
+        long enc_size = calculate_encoded_size(in_size, _m);
+        hbuf_t out_buf;
+        if (!hbuf_alloc(&out_buf, enc_size, _huge)) {
+            hbuf_free(&in_buf);
             return EXIT_FAILURE;
         }
 
+        char* encoded = (char*)out_buf.data;
+
+        pool_touch(encoded, enc_size);
         encode_hamming_array((const byte_t*)buffer, in_size, (byte_t*)encoded, _m);
-        fwrite(encoded, 1, enc_size, fo);
-        free(encoded);
+        _numa_report(encoded, enc_size);
+        written = dio_write(&fo, encoded, enc_size) >= 0;
+        hbuf_free(&out_buf);
     }
 
-    fclose(fo);
-    free(buffer);
-    return EXIT_SUCCESS;
+    int res = dio_close(&fo) && written ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (res != EXIT_SUCCESS) fprintf(stderr, "[file2hamm] cannot write %s\n", _out_path);
+    hbuf_free(&in_buf);
+    return res;
 }
@@ -1,4 +1,321 @@
 #include <hamm.h>
+#include <cpu.h>
+#include <pool.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#define HAMM_FAST_MAX_M 9
+#define HAMM_MAX_WORDS  (((1 << HAMM_FAST_MAX_M) + 63) / 64)
+
+#define HAMM_LE (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+
+/* Data bits per pool task (64 KB of input). */
+#define HAMM_TASK_BITS (1L << 19)
+
+typedef unsigned long long hword_t;
+
+/*
+Per-m state shared by every block of a call (and every buffer of a batch).
+masks[p] selects every codeword position covered by parity bit p,
+so syndrome bit p is just the parity of (codeword & masks[p]).
+*/
+typedef struct {
+    int     m;
+    long    n;
+    long    k;
+    long    words;
+    hword_t masks[HAMM_FAST_MAX_M][HAMM_MAX_WORDS];
+} hamm_tables_t;
+
+static void _build_tables(hamm_tables_t* t, int m) {
+    t->m = m;
+    t->n = (1 << m) - 1;
+    t->k = t->n - m;
+    t->words = (t->n + 63) / 64;
+    str_memset(t->masks, 0, sizeof(t->masks));
+    for (int p = 0; p < m; p++) {
+        for (long i = 1; i <= t->n; i++) {
+            if (i & (1 << p)) t->masks[p][(i - 1) / 64] |= 1ULL << ((i - 1) % 64);
+        }
+    }
+}
+
+static inline hword_t _get_words_bits(const hword_t* w, long bit, int count) {
+    long i = bit / 64;
+    int shift = bit % 64;
+    hword_t val = w[i] >> shift;
+    if (shift && shift + count > 64) val |= w[i + 1] << (64 - shift);
+    return count < 64 ? val & ((1ULL << count) - 1) : val;
+}
+
+static inline void _or_words_bits(hword_t* w, long bit, int count, hword_t val) {
+    long i = bit / 64;
+    int shift = bit % 64;
+    w[i] |= val << shift;
+    if (shift && shift + count > 64) w[i + 1] |= val >> (64 - shift);
+}
+
+/*
+Load count (<= n) codeword bits starting at bit, the rest of the codeword reads as zero.
+*/
+static inline void _load_codeword(const hamm_tables_t* t, const byte_t* in, long bit, long count, hword_t* cw) {
+    for (long w = 0; w < t->words; w++) {
+        long take = MIN(64, count - w * 64);
+        cw[w] = take > 0 ? get_bits_buff(in, bit + w * 64, (int)take) : 0;
+    }
+}
+
+static inline void _store_codeword(const hamm_tables_t* t, const hword_t* cw, byte_t* out, long bit) {
+    for (long w = 0; w < t->words; w++) {
+        set_bits_buff(out, bit + w * 64, (int)MIN(64, t->n - w * 64), cw[w]);
+    }
+}
+
+static inline long _syndrome(const hamm_tables_t* t, const hword_t* cw) {
+    long syndrome = 0;
+    for (int p = 0; p < t->m; p++) {
+        hword_t acc = 0;
+        for (long w = 0; w < t->words; w++) acc ^= cw[w] & t->masks[p][w];
+        syndrome |= (long)__builtin_parityll(acc) << p;
+    }
+
+    return syndrome;
+}
+
+/*
+Data bits sit in contiguous runs between parity positions:
+bits [2^p, 2^(p+1) - 2] for p = 1..m-1. Copy them run by run.
+*/
+static inline void _extract_data(const hamm_tables_t* t, const hword_t* cw, byte_t* out, long out_bit) {
+    for (int p = 1; p < t->m; p++) {
+        long start = 1L << p;
+        long len = start - 1;
+        for (long i = 0; i < len; i += 64) {
+            int count = (int)MIN(64, len - i);
+            set_bits_buff(out, out_bit, count, _get_words_bits(cw, start + i, count));
+            out_bit += count;
+        }
+    }
+}
+
+/*
+Inverse of _extract_data: spread up to avail data bits over the runs,
+then fill every parity position from its mask.
+*/
+static inline void _place_data(const hamm_tables_t* t, const byte_t* in, long in_bit, long avail, hword_t* cw) {
+    for (long w = 0; w < t->words; w++) cw[w] = 0;
+    for (int p = 1; p < t->m && avail > 0; p++) {
+        long start = 1L << p;
+        long len = start - 1;
+        for (long i = 0; i < len && avail > 0; i += 64) {
+            int count = (int)MIN(MIN(64, len - i), avail);
+            _or_words_bits(cw, start + i, count, get_bits_buff(in, in_bit, count));
+            in_bit += count;
+            avail -= count;
+        }
+    }
+
+    for (int p = 0; p < t->m; p++) {
+        hword_t acc = 0;
+        for (long w = 0; w < t->words; w++) acc ^= cw[w] & t->masks[p][w];
+        if (__builtin_parityll(acc)) cw[((1L << p) - 1) / 64] |= 1ULL << (((1L << p) - 1) % 64);
+    }
+}
+
+/*
+Hamming(7,4) and (15,11) go through lookup tables: every data chunk maps
+straight to its codeword and every received codeword straight to corrected
+data. Blocks are handled in groups that start and end on byte boundaries
+(16 blocks = 8 data bytes for m = 3, 8 blocks = 11 data bytes for m = 4),
+so a whole group is one wide load, a few shifts and one wide store.
+*/
+#if defined(__SIZEOF_INT128__) && HAMM_LE
+#define HAMM_LUT 1
+
+typedef unsigned __int128 hwide_t;
+
+static unsigned char  _enc7[1 << 4];
+static unsigned char  _dec7[1 << 7];
+static unsigned short _enc15[1 << 11];
+static unsigned short _dec15[1 << 15];
+static pthread_once_t _lut_once = PTHREAD_ONCE_INIT;
+
+static void _fill_lut(int m, void* enc, void* dec) {
+    hamm_tables_t t;
+    _build_tables(&t, m);
+    for (long d = 0; d < (1L << t.k); d++) {
+        hword_t cw[HAMM_MAX_WORDS];
+        _place_data(&t, (const byte_t*)&d, 0, t.k, cw);
+        if (m == 3) ((unsigned char*)enc)[d] = (unsigned char)cw[0];
+        else ((unsigned short*)enc)[d] = (unsigned short)cw[0];
+    }
+
+    for (long c = 0; c < (1L << t.n); c++) {
+        hword_t cw[HAMM_MAX_WORDS] = { (hword_t)c };
+        long syndrome = _syndrome(&t, cw);
+        if (syndrome) cw[0] ^= 1ULL << (syndrome - 1);
+        unsigned long long data = 0;
+        _extract_data(&t, cw, (byte_t*)&data, 0);
+        if (m == 3) ((unsigned char*)dec)[c] = (unsigned char)data;
+        else ((unsigned short*)dec)[c] = (unsigned short)data;
+    }
+}
+
+static void _fill_luts() {
+    _fill_lut(3, _enc7, _dec7);
+    _fill_lut(4, _enc15, _dec15);
+}
+
+static void _init_lut() {
+    pthread_once(&_lut_once, _fill_luts);
+}
+
+static inline hwide_t _load_wide(const byte_t* p, int bytes) {
+    hwide_t v = 0;
+    __builtin_memcpy(&v, p, bytes);
+    return v;
+}
+
+static inline void _store_wide(byte_t* p, int bytes, hwide_t v) {
+    __builtin_memcpy(p, &v, bytes);
+}
+
+/*
+Encode whole groups, return count of blocks done.
+*/
+static long _encode_lut(int m, const byte_t* in, long in_size, byte_t* out) {
+    long groups = 0;
+    _init_lut();
+    if (m == 3) {
+        for (groups = 0; (groups + 1) * 8 <= in_size; groups++) {
+            hwide_t data = _load_wide(in + groups * 8, 8);
+            hwide_t cw = 0;
+            for (int i = 0; i < 16; i++) cw |= (hwide_t)_enc7[(data >> (4 * i)) & 0xF] << (7 * i);
+            _store_wide(out + groups * 14, 14, cw);
+        }
+
+        return groups * 16;
+    }
+
+    for (groups = 0; (groups + 1) * 11 <= in_size; groups++) {
+        hwide_t data = _load_wide(in + groups * 11, 11);
+        hwide_t cw = 0;
+        for (int i = 0; i < 8; i++) cw |= (hwide_t)_enc15[(data >> (11 * i)) & 0x7FF] << (15 * i);
+        _store_wide(out + groups * 15, 15, cw);
+    }
+
+    return groups * 8;
+}
+
+static long _decode_lut(int m, const byte_t* in, long in_size, byte_t* out) {
+    long groups = 0;
+    _init_lut();
+    if (m == 3) {
+        for (groups = 0; (groups + 1) * 14 <= in_size; groups++) {
+            hwide_t cw = _load_wide(in + groups * 14, 14);
+            hwide_t data = 0;
+            for (int i = 0; i < 16; i++) data |= (hwide_t)_dec7[(cw >> (7 * i)) & 0x7F] << (4 * i);
+            _store_wide(out + groups * 8, 8, data);
+        }
+
+        return groups * 16;
+    }
+
+    for (groups = 0; (groups + 1) * 15 <= in_size; groups++) {
+        hwide_t cw = _load_wide(in + groups * 15, 15);
+        hwide_t data = 0;
+        for (int i = 0; i < 8; i++) data |= (hwide_t)_dec15[(cw >> (15 * i)) & 0x7FFF] << (11 * i);
+        _store_wide(out + groups * 11, 11, data);
+    }
+
+    return groups * 8;
+}
+#else
+#define HAMM_LUT 0
+#endif
+
+/*
+Blocks [b, end) of one call. Ranges start on 16-block boundaries, which are
+byte boundaries on both sides (and whole lookup table groups), so ranges
+running on different pool workers never share a byte.
+*/
+static inline void _encode_range(const hamm_tables_t* t, const byte_t* in, long in_bits, byte_t* out, long b, long end) {
+    hword_t cw[HAMM_MAX_WORDS];
+#if HAMM_LUT
+    if ((t->m == 3 || t->m == 4) && b % 16 == 0) {
+        long bytes = MIN((end - b) * t->k, in_bits - b * t->k) / 8;
+        b += _encode_lut(t->m, in + b * t->k / 8, bytes, out + b * t->n / 8);
+    }
+#endif
+    for (; b < end; b++) {
+        _place_data(t, in, b * t->k, MIN(t->k, in_bits - b * t->k), cw);
+        _store_codeword(t, cw, out, b * t->n);
+    }
+}
+
+static inline void _decode_range(const hamm_tables_t* t, const byte_t* in, long in_bits, byte_t* out, long b, long end) {
+    hword_t cw[HAMM_MAX_WORDS];
+#if HAMM_LUT
+    if ((t->m == 3 || t->m == 4) && b % 16 == 0) {
+        long bytes = MIN((end - b) * t->n, in_bits - b * t->n) / 8;
+        b += _decode_lut(t->m, in + b * t->n / 8, bytes, out + b * t->k / 8);
+    }
+#endif
+    for (; b < end; b++) {
+        _load_codeword(t, in, b * t->n, MIN(t->n, in_bits - b * t->n), cw);
+        long syndrome = _syndrome(t, cw);
+        if (syndrome) cw[(syndrome - 1) / 64] ^= 1ULL << ((syndrome - 1) % 64);
+        _extract_data(t, cw, out, b * t->k);
+    }
+}
+
+typedef struct {
+    const hamm_tables_t* t;
+    const byte_t*        in;
+    long                 in_bits;
+    byte_t*              out;
+} hamm_job_t;
+
+HAMM_KERNEL static void _encode_task(void* ctx, long begin, long end) {
+    hamm_job_t* job = (hamm_job_t*)ctx;
+    _encode_range(job->t, job->in, job->in_bits, job->out, begin, end);
+}
+
+HAMM_KERNEL static void _decode_task(void* ctx, long begin, long end) {
+    hamm_job_t* job = (hamm_job_t*)ctx;
+    _decode_range(job->t, job->in, job->in_bits, job->out, begin, end);
+}
+
+/*
+Every codeword bit of the output is overwritten, only padding bits
+of the last byte need zeroing. Large inputs are spread over the pool.
+*/
+static inline long _encode_blocks(const hamm_tables_t* t, const byte_t* in, long in_size, byte_t* out) {
+    long in_bits = in_size * 8;
+    long blocks = (in_bits + t->k - 1) / t->k;
+    long out_size = ((blocks * t->n) + 7) / 8;
+    if (out_size) out[out_size - 1] = 0;
+
+    hamm_job_t job = { .t = t, .in = in, .in_bits = in_bits, .out = out };
+    pool_parallel_for(blocks, HAMM_TASK_BITS / t->k, 16, _encode_task, &job);
+    return out_size;
+}
+
+/*
+Word-wide syndrome check per block: clean blocks are copied out run by run,
+only dirty ones get their bit toggled first.
+*/
+static inline long _decode_blocks(const hamm_tables_t* t, const byte_t* in, long in_size, byte_t* out) {
+    long in_bits = in_size * 8;
+    long blocks = (in_bits + t->n - 1) / t->n;
+    long out_size = ((blocks * t->k) + 7) / 8;
+    if (out_size) out[out_size - 1] = 0;
+
+    hamm_job_t job = { .t = t, .in = in, .in_bits = in_bits, .out = out };
+    pool_parallel_for(blocks, HAMM_TASK_BITS / t->k, 16, _decode_task, &job);
+    return out_size;
+}
 
 int encode_hamming(void* src, void* out, long m) {
     long n = (1 << m) - 1;
@@ -68,7 +385,10 @@ int decode_hamming(void* src, void* out, long m) {
     return 1;
 }
 
-long encode_hamming_array(const byte_t* in, long in_size, byte_t* out, int m) {
+/*
+Original per-bit path, kept for m > HAMM_FAST_MAX_M.
+*/
+long encode_hamming_array_scalar(const byte_t* in, long in_size, byte_t* out, int m) {
     long n = (1 << m) - 1;
     long k = n - m;
 
@@ -77,20 +397,16 @@ long encode_hamming_array(const byte_t* in, long in_size, byte_t* out, int m) {
     long out_size = ((blocks * n) + 7) / 8;
 
     str_memset(out, 0, out_size);
+
+    /* Per-thread scratch instead of an allocation per block. */
+    byte_t* block_in = (byte_t*)pool_scratch((n + 7) / 8 * 2);
+    if (!block_in) return -1;
+    byte_t* block_out = block_in + (n + 7) / 8;
     
     for (long b = 0; b < blocks; b++) {
         long in_offset_bits = b * k;
         long out_offset_bits = b * n;
         
-        byte_t* block_in = (byte_t*)ll_malloc((k + 7) / 8);
-        byte_t* block_out = (byte_t*)ll_malloc((n + 7) / 8);
-        
-        if (!block_in || !block_out) {
-            ll_free(block_in);
-            ll_free(block_out);
-            return -1;
-        }
-        
         str_memset(block_in, 0, (k + 7) / 8);
         str_memset(block_out, 0, (n + 7) / 8);
         
@@ -105,15 +421,12 @@ long encode_hamming_array(const byte_t* in, long in_size, byte_t* out, int m) {
             byte_t bit = get_bit_buff(block_out, i);
             set_bit_buff(out, out_offset_bits + i, bit);
         }
-        
-        ll_free(block_in);
-        ll_free(block_out);
     }
 
     return out_size;
 }
 
-long decode_hamming_array(const byte_t* in, long in_size, byte_t* out, int m) {
+long decode_hamming_array_scalar(const byte_t* in, long in_size, byte_t* out, int m) {
     long n = (1 << m) - 1;
     long k = n - m;
 
@@ -122,20 +435,16 @@ long decode_hamming_array(const byte_t* in, long in_size, byte_t* out, int m) {
     long out_size = ((blocks * k) + 7) / 8;
 
     str_memset(out, 0, out_size);
+
+    /* Per-thread scratch instead of an allocation per block. */
+    byte_t* block_in = (byte_t*)pool_scratch((n + 7) / 8 * 2);
+    if (!block_in) return -1;
+    byte_t* block_out = block_in + (n + 7) / 8;
     
     for (long b = 0; b < blocks; b++) {
         long in_offset_bits = b * n;
         long out_offset_bits = b * k;
         
-        byte_t* block_in = (byte_t*)ll_malloc((n + 7) / 8);
-        byte_t* block_out = (byte_t*)ll_malloc((k + 7) / 8);
-        
-        if (!block_in || !block_out) {
-            ll_free(block_in);
-            ll_free(block_out);
-            return -1;
-        }
-        
         str_memset(block_in, 0, (n + 7) / 8);
         str_memset(block_out, 0, (k + 7) / 8);
         
@@ -150,10 +459,378 @@ long decode_hamming_array(const byte_t* in, long in_size, byte_t* out, int m) {
             byte_t bit = get_bit_buff(block_out, i);
             set_bit_buff(out, out_offset_bits + i, bit);
         }
-        
-        ll_free(block_in);
-        ll_free(block_out);
     }
 
     return out_size;
 }
+
+HAMM_KERNEL long encode_hamming_array(const byte_t* in, long in_size, byte_t* out, int m) {
+    if (m > HAMM_FAST_MAX_M) return encode_hamming_array_scalar(in, in_size, out, m);
+    hamm_tables_t t;
+    _build_tables(&t, m);
+    return _encode_blocks(&t, in, in_size, out);
+}
+
+HAMM_KERNEL long decode_hamming_array(const byte_t* in, long in_size, byte_t* out, int m) {
+    if (m > HAMM_FAST_MAX_M) return decode_hamming_array_scalar(in, in_size, out, m);
+    hamm_tables_t t;
+    _build_tables(&t, m);
+    return _decode_blocks(&t, in, in_size, out);
+}
+
+typedef struct {
+    const hamm_tables_t* t;
+    byte_t*              buf;
+    long                 stride;
+    atomic_long          corrected;
+} hamm_fix_job_t;
+
+/* Only the erroneous bit is written back, 16-block ranges keep tasks off each other's bytes. */
+HAMM_KERNEL static void _correct_task(void* ctx, long begin, long end) {
+    hamm_fix_job_t* job = (hamm_fix_job_t*)ctx;
+    const hamm_tables_t* t = job->t;
+    hword_t cw[HAMM_MAX_WORDS];
+    long corrected = 0;
+    for (long b = begin; b < end; b++) {
+        _load_codeword(t, job->buf, b * t->n, t->n, cw);
+        long syndrome = _syndrome(t, cw);
+        if (!syndrome) continue;
+        toggle_bit_buff(job->buf, b * t->n + syndrome - 1);
+        corrected++;
+    }
+
+    if (corrected) atomic_fetch_add(&job->corrected, corrected);
+}
+
+HAMM_KERNEL long correct_hamming_array(byte_t* buf, long blocks, int m) {
+    if (m < 2 || m > HAMM_FAST_MAX_M) return -1;
+    hamm_tables_t t;
+    _build_tables(&t, m);
+
+    hamm_fix_job_t job = { .t = &t, .buf = buf };
+    atomic_init(&job.corrected, 0);
+    pool_parallel_for(blocks, HAMM_TASK_BITS / t.n, 16, _correct_task, &job);
+    return atomic_load(&job.corrected);
+}
+
+/*
+Batch job: every item's blocks are laid end to end in one range, each item
+padded to a 16-block boundary, so one pool_parallel_for covers the batch,
+small items share tasks and no task boundary splits a byte of any item.
+starts[i] is the first range index of item i, starts[count] the range size.
+*/
+typedef struct {
+    const hamm_tables_t* t;
+    hamm_batch_t*        items;
+    long                 count;
+    const long*          starts;
+    int                  encode;
+} hamm_batch_job_t;
+
+HAMM_KERNEL static void _batch_task(void* ctx, long begin, long end) {
+    hamm_batch_job_t* job = (hamm_batch_job_t*)ctx;
+    long low = 0, high = job->count - 1;
+    while (low < high) {
+        long mid = (low + high + 1) / 2;
+        if (job->starts[mid] <= begin) low = mid;
+        else high = mid - 1;
+    }
+
+    for (long i = low; i < job->count && job->starts[i] < end; i++) {
+        const hamm_batch_t* item = &job->items[i];
+        long in_bits = item->len * 8;
+        long blocks = (in_bits + (job->encode ? job->t->k : job->t->n) - 1) / (job->encode ? job->t->k : job->t->n);
+        long b = MAX(begin, job->starts[i]) - job->starts[i];
+        long e = MIN(MIN(end, job->starts[i + 1]) - job->starts[i], blocks);
+        if (b >= e) continue;
+        if (job->encode) _encode_range(job->t, item->src, in_bits, item->dst, b, e);
+        else _decode_range(job->t, item->src, in_bits, item->dst, b, e);
+    }
+}
+
+static long _code_batch(hamm_batch_t* items, long count, int m, int encode) {
+    long total = 0;
+    if (count <= 0) return 0;
+    if (m > HAMM_FAST_MAX_M) {
+        for (long i = 0; i < count; i++) {
+            items[i].out_size = encode ? encode_hamming_array_scalar(items[i].src, items[i].len, items[i].dst, m) :
+                                         decode_hamming_array_scalar(items[i].src, items[i].len, items[i].dst, m);
+            if (items[i].out_size < 0) return -1;
+            total += items[i].out_size;
+        }
+
+        return total;
+    }
+
+    long* starts = (long*)malloc((count + 1) * sizeof(long));
+    if (!starts) return -1;
+
+    hamm_tables_t t;
+    _build_tables(&t, m);
+    long in_block = encode ? t.k : t.n, out_block = encode ? t.n : t.k;
+    starts[0] = 0;
+    for (long i = 0; i < count; i++) {
+        long blocks = (items[i].len * 8 + in_block - 1) / in_block;
+        items[i].out_size = (blocks * out_block + 7) / 8;
+        if (items[i].out_size) items[i].dst[items[i].out_size - 1] = 0;
+        total += items[i].out_size;
+        starts[i + 1] = starts[i] + (blocks + 15) / 16 * 16;
+    }
+
+    hamm_batch_job_t job = { .t = &t, .items = items, .count = count, .starts = starts, .encode = encode };
+    pool_parallel_for(starts[count], HAMM_TASK_BITS / t.k, 16, _batch_task, &job);
+    free(starts);
+    return total;
+}
+
+HAMM_KERNEL long encode_hamming_batch(hamm_batch_t* items, long count, int m) {
+    return _code_batch(items, count, m, 1);
+}
+
+HAMM_KERNEL long decode_hamming_batch(hamm_batch_t* items, long count, int m) {
+    return _code_batch(items, count, m, 0);
+}
+
+/*
+Aligned layout: codeword b is the low n bits of the stride bytes at b * stride,
+so it moves with plain copies instead of shifting across byte boundaries.
+*/
+static inline void _load_aligned(const hamm_tables_t* t, const byte_t* in, long stride, hword_t* cw) {
+    for (long w = 0; w < t->words; w++) cw[w] = 0;
+#if HAMM_LE
+    __builtin_memcpy(cw, in, stride);
+#else
+    for (long w = 0; w < t->words; w++) cw[w] = get_bits_buff(in, w * 64, (int)MIN(64, stride * 8 - w * 64));
+#endif
+    if (t->n % 64) cw[t->words - 1] &= (1ULL << (t->n % 64)) - 1;
+}
+
+static inline void _store_aligned(const hword_t* cw, byte_t* out, long stride) {
+#if HAMM_LE
+    __builtin_memcpy(out, cw, stride);
+#else
+    for (long w = 0; w * 64 < stride * 8; w++) set_bits_buff(out, w * 64, (int)MIN(64, stride * 8 - w * 64), cw[w]);
+#endif
+}
+
+HAMM_KERNEL long encode_hamming_aligned(const byte_t* in, long in_size, byte_t* out, int m) {
+    if (m < 2 || m > HAMM_FAST_MAX_M) return -1;
+    hamm_tables_t t;
+    _build_tables(&t, m);
+
+    hword_t cw[HAMM_MAX_WORDS];
+    long stride = hamm_aligned_stride(m);
+    long in_bits = in_size * 8;
+    long blocks = (in_bits + t.k - 1) / t.k;
+    long b = 0;
+
+#if HAMM_LUT
+    if (m == 3) {
+        _init_lut();
+        for (long i = 0; i < in_size; i++) {
+            out[2 * i] = _enc7[in[i] & 0xF];
+            out[2 * i + 1] = _enc7[in[i] >> 4];
+        }
+
+        b = blocks;
+    }
+    else if (m == 4) {
+        _init_lut();
+        for (long g = 0; (g + 1) * 11 <= in_size; g++, b += 8) {
+            hwide_t data = _load_wide(in + g * 11, 11);
+            for (int i = 0; i < 8; i++) {
+                unsigned short word = _enc15[(data >> (11 * i)) & 0x7FF];
+                __builtin_memcpy(out + (b + i) * 2, &word, 2);
+            }
+        }
+    }
+#endif
+
+    for (; b < blocks; b++) {
+        _place_data(&t, in, b * t.k, MIN(t.k, in_bits - b * t.k), cw);
+        _store_aligned(cw, out + b * stride, stride);
+    }
+
+    return blocks * stride;
+}
+
+HAMM_KERNEL long decode_hamming_aligned(const byte_t* in, long in_size, byte_t* out, int m) {
+    if (m < 2 || m > HAMM_FAST_MAX_M) return -1;
+    hamm_tables_t t;
+    _build_tables(&t, m);
+
+    hword_t cw[HAMM_MAX_WORDS];
+    long stride = hamm_aligned_stride(m);
+    long blocks = in_size / stride;
+    long out_size = (blocks * t.k + 7) / 8;
+    if (out_size) out[out_size - 1] = 0;
+    long b = 0;
+
+#if HAMM_LUT
+    if (m == 3) {
+        _init_lut();
+        for (; b + 2 <= blocks; b += 2) {
+            out[b / 2] = _dec7[in[b] & 0x7F] | (_dec7[in[b + 1] & 0x7F] << 4);
+        }
+    }
+    else if (m == 4) {
+        _init_lut();
+        for (; b + 8 <= blocks; b += 8) {
+            hwide_t data = 0;
+            for (int i = 0; i < 8; i++) {
+                unsigned short word;
+                __builtin_memcpy(&word, in + (b + i) * 2, 2);
+                data |= (hwide_t)_dec15[word & 0x7FFF] << (11 * i);
+            }
+
+            _store_wide(out + b / 8 * 11, 11, data);
+        }
+    }
+#endif
+
+    for (; b < blocks; b++) {
+        _load_aligned(&t, in + b * stride, stride, cw);
+        long syndrome = _syndrome(&t, cw);
+        if (syndrome) cw[(syndrome - 1) / 64] ^= 1ULL << ((syndrome - 1) % 64);
+        _extract_data(&t, cw, out, b * t.k);
+    }
+
+    return out_size;
+}
+
+/* Codewords never share a byte here, so any range split works and clean blocks stay untouched. */
+HAMM_KERNEL static void _correct_aligned_task(void* ctx, long begin, long end) {
+    hamm_fix_job_t* job = (hamm_fix_job_t*)ctx;
+    const hamm_tables_t* t = job->t;
+    hword_t cw[HAMM_MAX_WORDS];
+    long corrected = 0;
+    for (long b = begin; b < end; b++) {
+        _load_aligned(t, job->buf + b * job->stride, job->stride, cw);
+        long syndrome = _syndrome(t, cw);
+        if (!syndrome) continue;
+        toggle_bit_buff(job->buf + b * job->stride, syndrome - 1);
+        corrected++;
+    }
+
+    if (corrected) atomic_fetch_add(&job->corrected, corrected);
+}
+
+HAMM_KERNEL long correct_hamming_aligned(byte_t* buf, long blocks, int m) {
+    if (m < 2 || m > HAMM_FAST_MAX_M) return -1;
+    hamm_tables_t t;
+    _build_tables(&t, m);
+
+    hamm_fix_job_t job = { .t = &t, .buf = buf, .stride = hamm_aligned_stride(m) };
+    atomic_init(&job.corrected, 0);
+    pool_parallel_for(blocks, HAMM_TASK_BITS / t.n, 1, _correct_aligned_task, &job);
+    return atomic_load(&job.corrected);
+}
+
+void hamm_llr_split(const float* llr, long bits, byte_t* hard, byte_t* reliability, float scale, int msb_first) {
+    str_memset(hard, 0, (bits + 7) / 8);
+    for (long i = 0; i < bits; i++) {
+        float magnitude = (llr[i] < 0 ? -llr[i] : llr[i]) * scale;
+        reliability[i] = magnitude >= 255.0f ? 255 : (byte_t)magnitude;
+        if (llr[i] < 0) hard[i / 8] |= msb_first ? 0x80 >> (i % 8) : 1 << (i % 8);
+    }
+}
+
+typedef struct {
+    const hamm_tables_t* t;
+    const byte_t*        in;
+    const byte_t*        reliability;
+    long                 in_bits;
+    byte_t*              out;
+    int                  p;
+    atomic_long          corrected;
+} hamm_soft_job_t;
+
+/* Indexes of the p smallest reliabilities among count bits, ascending. Return how many were found. */
+static int _least_reliable(const byte_t* rel, long count, int p, long* lrp) {
+    int found = 0;
+    for (long i = 0; p && i < count; i++) {
+        if (found == p && rel[i] >= rel[lrp[p - 1]]) continue;
+        int j = found < p ? found++ : p - 1;
+        for (; j > 0 && rel[lrp[j - 1]] > rel[i]; j--) lrp[j] = lrp[j - 1];
+        lrp[j] = i;
+    }
+
+    return found;
+}
+
+/*
+Syndromes are linear and position i (1-based) has syndrome i, so a test pattern
+only changes the syndrome by the XOR of its positions: no candidate is ever
+decoded for real, the winner is applied once.
+*/
+HAMM_KERNEL static void _soft_task(void* ctx, long begin, long end) {
+    hamm_soft_job_t* job = (hamm_soft_job_t*)ctx;
+    const hamm_tables_t* t = job->t;
+    hword_t cw[HAMM_MAX_WORDS];
+    long lrp[HAMM_CHASE_MAX_P];
+    long corrected = 0;
+    for (long b = begin; b < end; b++) {
+        long base = b * t->n;
+        long avail = MIN(t->n, job->in_bits - base);
+        _load_codeword(t, job->in, base, avail, cw);
+        long syndrome = _syndrome(t, cw);
+        if (syndrome) {
+            const byte_t* rel = job->reliability + base;
+            int p = _least_reliable(rel, avail, job->p, lrp);
+            long best_pattern = 0, best_s = syndrome;
+            int best_undo = 0;
+            unsigned long best_metric = ~0UL;
+            for (long pattern = 0; pattern < 1L << p; pattern++) {
+                long s = syndrome;
+                unsigned long metric = 0;
+                for (int i = 0; i < p; i++) {
+                    if (!((pattern >> i) & 1)) continue;
+                    s ^= lrp[i] + 1;
+                    metric += rel[lrp[i]];
+                }
+
+                /* The decoder flip lands on a test position (undoing it) or on a fresh bit, padding counts as certain. */
+                int undo = 0;
+                for (int i = 0; s && i < p; i++) undo |= ((pattern >> i) & 1) && lrp[i] == s - 1;
+                if (undo) metric -= rel[s - 1];
+                else if (s) metric += s - 1 < avail ? rel[s - 1] : 255;
+
+                if (metric < best_metric) {
+                    best_metric = metric;
+                    best_pattern = pattern;
+                    best_s = s;
+                    best_undo = undo;
+                }
+            }
+
+            for (int i = 0; i < p; i++) {
+                if ((best_pattern >> i) & 1) cw[lrp[i] / 64] ^= 1ULL << (lrp[i] % 64);
+            }
+
+            if (best_s) cw[(best_s - 1) / 64] ^= 1ULL << ((best_s - 1) % 64);
+            corrected += __builtin_popcountl(best_pattern) + (best_undo ? -1 : best_s != 0);
+        }
+
+        _extract_data(t, cw, job->out, b * t->k);
+    }
+
+    if (corrected) atomic_fetch_add(&job->corrected, corrected);
+}
+
+HAMM_KERNEL long decode_hamming_soft(const byte_t* in, const byte_t* reliability, long in_size, byte_t* out, int m, int p, long* corrected) {
+    if (corrected) *corrected = 0;
+    if (m < 2 || m > HAMM_FAST_MAX_M || p < 0 || p > HAMM_CHASE_MAX_P) return -1;
+    hamm_tables_t t;
+    _build_tables(&t, m);
+
+    long in_bits = in_size * 8;
+    long blocks = (in_bits + t.n - 1) / t.n;
+    long out_size = ((blocks * t.k) + 7) / 8;
+    if (out_size) out[out_size - 1] = 0;
+
+    hamm_soft_job_t job = { .t = &t, .in = in, .reliability = reliability, .in_bits = in_bits, .out = out, .p = p };
+    atomic_init(&job.corrected, 0);
+    pool_parallel_for(blocks, HAMM_TASK_BITS / t.k / (1 + p), 16, _soft_task, &job);
+    if (corrected) *corrected = atomic_load(&job.corrected);
+    return out_size;
+}
@@ -2,66 +2,284 @@
 #include <string.h>
 #include <stdlib.h>
 #include <hamm/hamm.h>
+#include <hamm/container.h>
+#include <hamm/product.h>
+#include <hamm/scrub.h>
+#include <pool.h>
+#include <hbuf.h>
+#include <dio.h>
 
 #define PARITY_BITS_ARG "--pb"
 #define TARGET_ARG      "--target"
 #define OUTPUT_ARG      "--out"
+#define STATS_ARG       "--stats"
+#define NUMA_ARG        "--numa"
+#define HUGE_ARG        "--huge"
+#define DIRECT_ARG      "--direct"
+#define SCRUB_ARG       "--scrub"
+
+#define MIN_M        2
+#define MAX_M        16 /* packed layout, decode_hamming_array_scalar past 9 */
+#define LAYOUT_MAX_M 9  /* aligned and product layouts */
 
 static int _m = 4;
+static int _numa = 0;
+static int _huge = 0;
+static int _direct = 0;
+static int _scrub = 0;
+static const char* _stats    = NULL;
 static const char* _target   = "image.hamm";
 static const char* _out_path = "image.img";
 
+/*
+Grow a streaming buffer, contents are not kept.
+*/
+static int _reserve(hbuf_t* buf, long size) {
+    if (buf->data && buf->size >= (unsigned long)size) return 1;
+    hbuf_free(buf);
+    return hbuf_alloc(buf, size, _huge);
+}
+
+/*
+Stream chunks one by one, every chunk is decoded with its own code.
+With --stats every chunk leaves a "<chunk> <corrected bits> <coded bits>" line.
+Chunks whose CRC32C still mismatches after recovery are reported and fail the run.
+*/
+static int _decode_chunked(dio_file_t* src_f, dio_file_t* fo) {
+    FILE* stats_f = _stats ? fopen(_stats, "w") : NULL;
+    hbuf_t body_buf = { 0 }, dec_buf = { 0 };
+    long total = 0, total_corrected = 0, index = 0, recovered = 0, corrupt = 0;
+    int res = EXIT_SUCCESS;
+
+    hamm_chunk_t chunk;
+    for (; dio_read(src_f, &chunk, sizeof(chunk)) == sizeof(chunk); index++) {
+        long dec_size = hamm_chunk_decoded_bound(&chunk);
+        if (dec_size < 0 || !_reserve(&body_buf, chunk.enc_size) || !_reserve(&dec_buf, dec_size) ||
+            dio_read(src_f, body_buf.data, chunk.enc_size) != chunk.enc_size) {
+            fprintf(stderr, "[hamm2file] chunk %ld is broken or truncated!\n", index);
+            res = EXIT_FAILURE;
+            break;
+        }
+
+        long corrected = 0;
+        int state = HAMM_CHUNK_OK;
+        byte_t* decoded = (byte_t*)dec_buf.data;
+        long size = hamm_chunk_decode(&chunk, (const byte_t*)body_buf.data, decoded, &corrected, &state);
+        if (size < 0) {
+            res = EXIT_FAILURE;
+            break;
+        }
+
+        if (state == HAMM_CHUNK_RECOVERED) recovered++;
+        else if (state == HAMM_CHUNK_CORRUPT) {
+            fprintf(stderr, "[hamm2file] chunk %ld: CRC mismatch, data is damaged\n", index);
+            corrupt++;
+            res = EXIT_FAILURE;
+        }
+
+        if (dio_write(fo, decoded, size) < 0) {
+            fprintf(stderr, "[hamm2file] cannot write %s\n", _out_path);
+            res = EXIT_FAILURE;
+            break;
+        }
+
+        if (stats_f) fprintf(stats_f, "%ld %ld %ld\n", index, corrected, (long)chunk.enc_size * 8);
+        total += size;
+        total_corrected += corrected;
+    }
+
+    fprintf(stdout, "[hamm2file] chunks=%ld, out=%ld, corrected=%ld, recovered=%ld, corrupt=%ld\n", index, total, total_corrected, recovered, corrupt);
+    if (stats_f) fclose(stats_f);
+    hbuf_free(&body_buf);
+    hbuf_free(&dec_buf);
+    return res;
+}
+
+/*
+Where the pages of a NUMA-placed buffer ended up and how many tasks crossed nodes.
+*/
+static void _numa_report(const void* buf, long size) {
+    pool_numa_stats_t stats;
+    if (!_numa) return;
+    int known = pool_numa_stats(buf, size, &stats);
+    fprintf(stdout, "[%s] numa nodes=%d, remote tasks=%ld/%ld", "hamm2file", stats.nodes, stats.remote_tasks, stats.tasks);
+    if (known) fprintf(stdout, ", remote pages=%ld/%ld\n", stats.remote_pages, stats.pages);
+    else fprintf(stdout, ", page placement unknown\n");
+}
+
+static int _scrub_file() {
+    ll_init();
+    hamm_scrub_stats_t stats;
+    int res = hamm_scrub(_target, _m, &stats);
+    if (res < 0) {
+        fprintf(stderr, "[hamm2file] %s: layout flags=%i, m=%i cannot be scrubbed\n", _target, stats.flags, stats.m);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(stdout, "[hamm2file] scrub %s: _m=%i, flags=%i, checked=%ld, corrected=%ld, written=%ld, chunks=%ld, corrupt=%ld\n",
+            _target, stats.m, stats.flags, stats.size, stats.corrected, stats.written, stats.chunks, stats.corrupt);
+    return res && !stats.corrupt ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 /*
 --pb - parity bits count (pb=0 => without decoding, just copy)
 --target - Target file for encoding
 --out - Path to save location (will create new file)
+--stats - Per-chunk corrected bits dump for file2hamm --adaptive --stats (chunked files only)
+--numa - Pin pool workers over the NUMA nodes, first-touch buffers per worker slice and report placement
+--huge - Back the codec buffers with huge pages (hugetlbfs, then THP, then regular pages)
+--direct - O_DIRECT I/O, leaves the page cache alone (target and out may be block devices)
+--scrub - Repair target in place (see scrub.h), nothing is decoded and --out is not written
+Files with a hamm_header_t in front are decoded with the m and layout it records.
 */
 int main(int argc, char* argv[]) {
     if (argc > 1) {
         for (int i = 1; i < argc; i++) {
-            if (!strcmp(argv[i], PARITY_BITS_ARG)) _m = atoi(argv[i++ + 1]);
-            else if (!strcmp(argv[i], TARGET_ARG)) _target = argv[i++ + 1];
-            else if (!strcmp(argv[i], OUTPUT_ARG)) _out_path = argv[i++ + 1];
-            else fprintf(stderr, "Unknown arg %s!\n", argv[i]);
+            const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+            if (!strcmp(argv[i], PARITY_BITS_ARG) && value) _m = atoi(argv[++i]);
+            else if (!strcmp(argv[i], TARGET_ARG) && value) _target = argv[++i];
+            else if (!strcmp(argv[i], OUTPUT_ARG) && value) _out_path = argv[++i];
+            else if (!strcmp(argv[i], STATS_ARG) && value) _stats = argv[++i];
+            else if (!strcmp(argv[i], NUMA_ARG)) _numa = 1;
+            else if (!strcmp(argv[i], HUGE_ARG)) _huge = HBUF_HUGE;
+            else if (!strcmp(argv[i], DIRECT_ARG)) _direct = DIO_DIRECT;
+            else if (!strcmp(argv[i], SCRUB_ARG)) _scrub = 1;
+            else {
+                fprintf(stderr, "Unknown arg %s or missing value!\n", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    if (_numa) pool_numa(1);
+    if (_scrub) return _scrub_file();
+
+    dio_file_t src_f, fo;
+    if (!dio_open(&src_f, _target, DIO_READ, _direct)) return EXIT_FAILURE;
+    long in_size = (long)src_f.size;
+    if (_direct && !src_f.direct) fprintf(stderr, "[hamm2file] O_DIRECT not supported for %s, using cached I/O\n", _target);
+
+    hamm_header_t header = { 0 };
+    int framed = in_size >= (long)sizeof(header) && dio_read(&src_f, &header, sizeof(header)) == sizeof(header) && header.magic == HAMM_MAGIC;
+    if (framed && (header.flags & ~(HAMM_FLAG_ALIGNED | HAMM_FLAG_CHUNKED | HAMM_FLAG_PRODUCT))) {
+        fprintf(stderr, "[hamm2file] %s is not a Hamming layout (flags=%i), decode it with ecc decode\n", _target, header.flags);
+        dio_close(&src_f);
+        return EXIT_FAILURE;
+    }
+
+    if (framed && (header.flags & HAMM_FLAG_CHUNKED)) {
+        fprintf(stdout, "[hamm2file] _target=%s, _out_path=%s, chunked\n", _target, _out_path);
+        if (!dio_open(&fo, _out_path, DIO_WRITE, _direct)) {
+            dio_close(&src_f);
+            return EXIT_FAILURE;
         }
+
+        ll_init();
+        int res = _decode_chunked(&src_f, &fo);
+        dio_close(&src_f);
+        if (!dio_close(&fo)) res = EXIT_FAILURE;
+        return res;
     }
 
-    fprintf(stdout, "[hamm2file] _target=%s, _out_path=%s, _m=%i\n", _target, _out_path, _m);
-    FILE* src_f = fopen(_target, "rb");
-    if (!src_f) return EXIT_FAILURE;
+    hbuf_t in_buf;
+    if (!dio_rewind(&src_f) || !hbuf_alloc(&in_buf, in_size, _huge)) {
+        dio_close(&src_f);
+        return EXIT_FAILURE;
+    }
+
+    char* buffer = (char*)in_buf.data;
+    if (_huge) fprintf(stdout, "[hamm2file] buffers=%s\n", hbuf_kind_name(in_buf.kind));
+
+    pool_touch(buffer, in_size);
+    long got = dio_read(&src_f, buffer, in_size);
+    in_size = MAX(got, 0);
+    dio_close(&src_f);
+
+    if (in_size >= (long)sizeof(header)) memcpy(&header, buffer, sizeof(header));
+    if (header.magic != HAMM_MAGIC) header.flags = 0;
+    else _m = header.m;
 
-    fseek(src_f, 0, SEEK_END);
-    long in_size = ftell(src_f);
-    fseek(src_f, 0, SEEK_SET);
+    fprintf(stdout, "[hamm2file] _target=%s, _out_path=%s, _m=%i, flags=%i\n", _target, _out_path, _m, header.flags);
 
-    char* buffer = (char*)malloc(in_size);
-    if (!buffer) {
-        fclose(src_f);
+    /* --pb 0 copies a headerless file as is, a header always names a real code. */
+    int max_m = header.flags & (HAMM_FLAG_ALIGNED | HAMM_FLAG_PRODUCT) ? LAYOUT_MAX_M : MAX_M;
+    if ((_m || header.magic == HAMM_MAGIC) && (_m < MIN_M || _m > max_m)) {
+        fprintf(stderr, "[hamm2file] m=%i is out of range [%i, %i] for this layout\n", _m, MIN_M, max_m);
+        hbuf_free(&in_buf);
         return EXIT_FAILURE;
     }
 
-    fread(buffer, 1, in_size, src_f);
-    fclose(src_f);
+    if (!dio_open(&fo, _out_path, DIO_WRITE, _direct)) {
+        hbuf_free(&in_buf);
+        return EXIT_FAILURE;
+    }
+
+    int decoded_ok = 1;
+    int written = 1;
+    if (!_m) written = dio_write(&fo, buffer, in_size) >= 0;
+    else if (header.flags & HAMM_FLAG_ALIGNED) {
+        long body_size = in_size - (long)sizeof(header);
+        long dec_size = calculate_decoded_size_aligned(body_size, _m);
+        hbuf_t out_buf;
+        if (!hbuf_alloc(&out_buf, dec_size, _huge)) {
+            hbuf_free(&in_buf);
+            return EXIT_FAILURE;
+        }
 
-    FILE* fo = fopen(_out_path, "wb");
-    if (!fo) return EXIT_FAILURE;
+        char* decoded = (char*)out_buf.data;
 
-    if (!_m) fwrite(buffer, 1, in_size, fo);
+        if (decode_hamming_aligned((const byte_t*)buffer + sizeof(header), body_size, (byte_t*)decoded, _m) < 0) {
+            fprintf(stderr, "[hamm2file] %s: aligned body does not decode with m=%i\n", _target, _m);
+            decoded_ok = 0;
+        }
+        else written = dio_write(&fo, decoded, MIN(dec_size, (long)header.size)) >= 0;
+        hbuf_free(&out_buf);
+    }
+    else if (header.flags & HAMM_FLAG_PRODUCT) {
+        ll_init();
+        long body_size = in_size - (long)sizeof(header);
+        long dec_size = calculate_decoded_size_product(body_size, _m);
+        hbuf_t out_buf;
+        if (!hbuf_alloc(&out_buf, dec_size, _huge)) {
+            hbuf_free(&in_buf);
+            return EXIT_FAILURE;
+        }
+
+        long corrected = 0;
+        char* decoded = (char*)out_buf.data;
+        if (decode_hamming_product((const byte_t*)buffer + sizeof(header), body_size, (byte_t*)decoded, _m, &corrected) < 0) {
+            fprintf(stderr, "[hamm2file] %s: product body does not decode with m=%i\n", _target, _m);
+            decoded_ok = 0;
+        }
+        else {
+            fprintf(stdout, "[hamm2file] corrected=%ld\n", corrected);
+            written = dio_write(&fo, decoded, MIN(dec_size, (long)header.size)) >= 0;
+        }
+        hbuf_free(&out_buf);
+    }
     else {
         ll_init();
         long dec_size = calculate_decoded_size(in_size, _m);
-        char* decoded = (char*)malloc(dec_size);
-        if (!decoded) {
-            free(buffer);
+        hbuf_t out_buf;
+        if (!hbuf_alloc(&out_buf, dec_size, _huge)) {
+            hbuf_free(&in_buf);
             return EXIT_FAILURE;
         }
 
-        decode_hamming_array((const byte_t*)buffer, in_size, (byte_t*)decoded, _m);
-        fwrite(decoded, 1, dec_size, fo);
-        free(decoded);
+        char* decoded = (char*)out_buf.data;
+
+        /* Packed layout behind a plain header (ecc encode): skip it, cut the tail padding. */
+        long skip = header.magic == HAMM_MAGIC ? (long)sizeof(header) : 0;
+        pool_touch(decoded, dec_size);
+        decode_hamming_array((const byte_t*)buffer + skip, in_size - skip, (byte_t*)decoded, _m);
+        _numa_report(decoded, dec_size);
+        written = dio_write(&fo, decoded, skip ? MIN(dec_size, (long)header.size) : dec_size) >= 0;
+        hbuf_free(&out_buf);
     }
 
-    fclose(fo);
-    free(buffer);
-    return EXIT_SUCCESS;
+    int res = dio_close(&fo) && written ? EXIT_SUCCESS : EXIT_FAILURE;
+    if (res != EXIT_SUCCESS) fprintf(stderr, "[hamm2file] cannot write %s\n", _out_path);
+    if (!decoded_ok) res = EXIT_FAILURE;
+    hbuf_free(&in_buf);
+    return res;
 }
@@ -0,0 +1,243 @@
+#include <product.h>
+#include <pool.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+/* Product blocks per pool task and per decoding group. Multiples of 8 blocks always end on a byte boundary. */
+#define HAMM_PRODUCT_TASK  64
+#define HAMM_PRODUCT_GROUP 8
+
+typedef struct {
+    const byte_t* src;
+    byte_t*       dst;
+    long          rows;
+    long          cols;
+    int           m;
+} product_job_t;
+
+/*
+In-register 64 x 64 bit transpose (bit c of word r <-> bit r of word c),
+log2(64) rounds of swapping off-diagonal sub-blocks.
+*/
+static inline void _transpose64(unsigned long long* a) {
+    unsigned long long mask = 0x00000000FFFFFFFFULL;
+    for (int j = 32; j; j >>= 1, mask ^= mask << j) {
+        for (int k = 0; k < 64; k = ((k | j) + 1) & ~j) {
+            unsigned long long t = ((a[k] >> j) ^ a[k | j]) & mask;
+            a[k] ^= t << j;
+            a[k | j] ^= t;
+        }
+    }
+}
+
+/*
+Bit matrix transpose of every block: rows x cols at src becomes cols x rows at dst.
+Blocks are walked in 64 x 64 tiles, one wide read per source row and one wide write per destination row.
+*/
+static void _transpose_task(void* ctx, long begin, long end) {
+    product_job_t* job = (product_job_t*)ctx;
+    long size = job->rows * job->cols;
+    unsigned long long tile[64];
+    for (long b = begin; b < end; b++) {
+        long base = b * size;
+        for (long r = 0; r < job->rows; r += 64) {
+            int height = (int)MIN(64, job->rows - r);
+            for (long c = 0; c < job->cols; c += 64) {
+                int width = (int)MIN(64, job->cols - c);
+                for (int i = 0; i < 64; i++) {
+                    tile[i] = i < height ? get_bits_buff(job->src, base + (r + i) * job->cols + c, width) : 0;
+                }
+
+                _transpose64(tile);
+                for (int i = 0; i < width; i++) set_bits_buff(job->dst, base + (c + i) * job->rows + r, height, tile[i]);
+            }
+        }
+    }
+}
+
+static void _transpose(const byte_t* src, byte_t* dst, long blocks, long rows, long cols) {
+    product_job_t job = { .src = src, .dst = dst, .rows = rows, .cols = cols };
+    pool_parallel_for(blocks, HAMM_PRODUCT_TASK, 8, _transpose_task, &job);
+}
+
+/*
+Data rows of a block are the non-power-of-two rows of the column code,
+their data bits the non-power-of-two columns of the row code.
+*/
+static void _extract_task(void* ctx, long begin, long end) {
+    product_job_t* job = (product_job_t*)ctx;
+    long n = job->rows;
+    long k = n - job->m;
+    for (long b = begin; b < end; b++) {
+        long out_bit = b * k * k;
+        for (long r = 1; r < n; r++) {
+            if (!(r & (r + 1))) continue;
+            long row = (b * n + r) * n;
+            for (int p = 1; p < job->m; p++) {
+                long start = 1L << p;
+                long len = start - 1;
+                for (long i = 0; i < len; i += 64) {
+                    int count = (int)MIN(64, len - i);
+                    set_bits_buff(job->dst, out_bit, count, get_bits_buff(job->src, row + start + i, count));
+                    out_bit += count;
+                }
+            }
+        }
+    }
+}
+
+long encode_hamming_product(const byte_t* in, long in_size, byte_t* out, int m) {
+    if (m < 2 || m > 9) return -1;
+    long n = (1 << m) - 1;
+    long k = n - m;
+    long blocks = (in_size * 8 + k * k - 1) / (k * k);
+    long out_size = calculate_encoded_size_product(in_size, m);
+    if (!blocks) return 0;
+
+    /*
+    rows: k row codewords per block (missing ones of the last block stay zero codewords).
+    cols: the same bits as n rows of k bits, column-encoded into n x n transposed blocks.
+    */
+    long rows_size = (blocks * k * n + 7) / 8;
+    long cols_size = calculate_encoded_size(rows_size, m);
+    byte_t* rows = (byte_t*)calloc(rows_size, 1);
+    byte_t* cols = (byte_t*)calloc(rows_size + cols_size, 1);
+    if (!rows || !cols) {
+        free(rows);
+        free(cols);
+        return -1;
+    }
+
+    encode_hamming_array(in, in_size, rows, m);
+    _transpose(rows, cols, blocks, k, n);
+    encode_hamming_array(cols, rows_size, cols + rows_size, m);
+    out[out_size - 1] = 0;
+    _transpose(cols + rows_size, out, blocks, n, n);
+
+    free(rows);
+    free(cols);
+    return out_size;
+}
+
+typedef struct {
+    byte_t*     matrix;
+    byte_t*     transposed;
+    long        n;
+    int         m;
+    atomic_long corrected;
+} product_fix_job_t;
+
+/*
+Iterate a few blocks to convergence. Columns first: a scratch or burst
+along a stored row leaves at most one error per column, while a row pass would
+miscorrect it and spread the damage. A pass that fixes nothing after the first
+one means the other direction is clean as well.
+*/
+static long _converge(product_fix_job_t* job, long begin, long end) {
+    long n = job->n;
+    long blocks = end - begin;
+    byte_t* matrix = job->matrix + begin * n * n / 8;
+    byte_t* transposed = job->transposed + begin * n * n / 8;
+    product_job_t rows = { .src = matrix, .dst = transposed, .rows = n, .cols = n };
+    product_job_t cols = { .src = transposed, .dst = matrix, .rows = n, .cols = n };
+
+    long total = 0;
+    for (int it = 0; it < HAMM_PRODUCT_ITERATIONS; it++) {
+        _transpose_task(&rows, 0, blocks);
+        long fixed = correct_hamming_array(transposed, blocks * n, job->m);
+        if (it && !fixed) break;
+        total += fixed;
+        if (fixed) _transpose_task(&cols, 0, blocks);
+
+        fixed = correct_hamming_array(matrix, blocks * n, job->m);
+        total += fixed;
+        if (!fixed) break;
+    }
+
+    return total;
+}
+
+/* Small independent groups: blocks that never converge only keep their own group busy. */
+static void _decode_task(void* ctx, long begin, long end) {
+    product_fix_job_t* job = (product_fix_job_t*)ctx;
+    long total = 0;
+    for (long b = begin; b < end; b += HAMM_PRODUCT_GROUP) total += _converge(job, b, MIN(end, b + HAMM_PRODUCT_GROUP));
+    if (total) atomic_fetch_add(&job->corrected, total);
+}
+
+long decode_hamming_product(const byte_t* in, long in_size, byte_t* out, int m, long* corrected) {
+    if (corrected) *corrected = 0;
+    if (m < 2 || m > 9) return -1;
+    long n = (1 << m) - 1;
+    long blocks = in_size * 8 / (n * n);
+    long out_size = calculate_decoded_size_product(in_size, m);
+    if (!blocks) return 0;
+
+    long size = (blocks * n * n + 7) / 8;
+    byte_t* matrix = (byte_t*)malloc(size * 2);
+    if (!matrix) return -1;
+    str_memcpy(matrix, in, size);
+
+    product_fix_job_t fix = { .matrix = matrix, .transposed = matrix + size, .n = n, .m = m };
+    atomic_init(&fix.corrected, 0);
+    pool_parallel_for(blocks, HAMM_PRODUCT_TASK, 8, _decode_task, &fix);
+
+    out[out_size - 1] = 0;
+    product_job_t job = { .src = matrix, .dst = out, .rows = n, .m = m };
+    pool_parallel_for(blocks, HAMM_PRODUCT_TASK, 8, _extract_task, &job);
+    free(matrix);
+
+    if (corrected) *corrected = atomic_load(&fix.corrected);
+    return out_size;
+}
+
+typedef struct {
+    byte_t*     buf;
+    long        n;
+    int         m;
+    atomic_long corrected;
+    atomic_int  failed;
+} product_scrub_job_t;
+
+/*
+Groups converge in a scratch copy (transposes rewrite every byte), only the
+bytes that changed go back to buf, so clean pages of a mapping stay clean.
+*/
+static void _scrub_task(void* ctx, long begin, long end) {
+    product_scrub_job_t* job = (product_scrub_job_t*)ctx;
+    long n = job->n;
+    long group_size = (HAMM_PRODUCT_GROUP * n * n + 7) / 8;
+    byte_t* scratch = (byte_t*)pool_scratch(group_size * 2);
+    if (!scratch) {
+        atomic_store(&job->failed, 1);
+        return;
+    }
+
+    long total = 0;
+    for (long b = begin; b < end; b += HAMM_PRODUCT_GROUP) {
+        long blocks = MIN(end - b, HAMM_PRODUCT_GROUP);
+        long size = (blocks * n * n + 7) / 8;
+        byte_t* src = job->buf + b * n * n / 8;
+        str_memcpy(scratch, src, size);
+
+        product_fix_job_t fix = { .matrix = scratch, .transposed = scratch + group_size, .n = n, .m = job->m };
+        long fixed = _converge(&fix, 0, blocks);
+        if (!fixed) continue;
+        total += fixed;
+        for (long i = 0; i < size; i++) {
+            if (src[i] != scratch[i]) src[i] = scratch[i];
+        }
+    }
+
+    if (total) atomic_fetch_add(&job->corrected, total);
+}
+
+long correct_hamming_product(byte_t* buf, long size, int m) {
+    if (m < 2 || m > 9) return -1;
+    long n = (1 << m) - 1;
+    product_scrub_job_t job = { .buf = buf, .n = n, .m = m };
+    atomic_init(&job.corrected, 0);
+    atomic_init(&job.failed, 0);
+    pool_parallel_for(size * 8 / (n * n), HAMM_PRODUCT_TASK, 8, _scrub_task, &job);
+    return atomic_load(&job.failed) ? -1 : atomic_load(&job.corrected);
+}
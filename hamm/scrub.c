@@ -0,0 +1,141 @@
+#define _GNU_SOURCE
+#include <scrub.h>
+#include <container.h>
+#include <product.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Store the bytes of src that differ from dst, return how many. Equal bytes are not written: a mapped page stays clean. */
+static long _store_diff(byte_t* dst, const byte_t* src, long size) {
+    long changed = 0;
+    for (long i = 0; i < size; i++) {
+        if (dst[i] == src[i]) continue;
+        dst[i] = src[i];
+        changed++;
+    }
+
+    return changed;
+}
+
+static int _reserve(byte_t** buf, long* capacity, long size) {
+    if (*capacity >= size) return 1;
+    byte_t* grown = (byte_t*)realloc(*buf, size);
+    if (!grown) return 0;
+    *buf = grown;
+    *capacity = size;
+    return 1;
+}
+
+/*
+Every chunk with corrections is re-encoded from its decoded data, which
+restores the exact codewords (parity and CRC included) whatever the codec.
+*/
+static int _scrub_chunked(byte_t* map, long size, hamm_scrub_stats_t* stats) {
+    byte_t* dec = NULL;
+    byte_t* enc = NULL;
+    long dec_capacity = 0, enc_capacity = 0;
+    int res = 1;
+
+    long off = sizeof(hamm_header_t);
+    for (hamm_chunk_t chunk; off + (long)sizeof(chunk) <= size; stats->chunks++) {
+        str_memcpy(&chunk, map + off, sizeof(chunk));
+        byte_t* body = map + off + sizeof(chunk);
+        off += sizeof(chunk) + chunk.enc_size;
+
+        long dec_size = hamm_chunk_decoded_bound(&chunk);
+        hamm_code_t code = { .codec = chunk.codec, .m = chunk.m, .t = chunk.t };
+        long enc_size = hamm_chunk_bound(chunk.size, &code, chunk.flags);
+        if (off > size || dec_size < 0 || enc_size != chunk.enc_size) {
+            stats->corrupt++;
+            res = off <= size;
+            break;
+        }
+
+        if (!_reserve(&dec, &dec_capacity, dec_size) || !_reserve(&enc, &enc_capacity, enc_size)) {
+            res = 0;
+            break;
+        }
+
+        long corrected = 0;
+        int state = HAMM_CHUNK_OK;
+        if (hamm_chunk_decode(&chunk, body, dec, &corrected, &state) < 0 || state == HAMM_CHUNK_CORRUPT) {
+            stats->corrupt++;
+            continue;
+        }
+
+        stats->size += chunk.enc_size;
+        if (!corrected && state == HAMM_CHUNK_OK) continue;
+
+        hamm_chunk_t info;
+        if (hamm_chunk_encode(dec, chunk.size, &code, chunk.flags, &info, enc) != enc_size) {
+            res = 0;
+            break;
+        }
+
+        stats->corrected += corrected;
+        stats->written += _store_diff(body, enc, enc_size);
+    }
+
+    free(dec);
+    free(enc);
+    return res;
+}
+
+static int _scrub_map(byte_t* map, long size, int m, hamm_scrub_stats_t* stats) {
+    hamm_header_t header = { 0 };
+    if (size >= (long)sizeof(header)) str_memcpy(&header, map, sizeof(header));
+    if (header.magic != HAMM_MAGIC) header.flags = 0;
+    else m = header.m;
+
+    stats->flags = header.flags;
+    stats->m = m;
+    if (header.flags & HAMM_FLAG_CHUNKED) return _scrub_chunked(map, size, stats);
+    if (header.flags & ~(HAMM_FLAG_ALIGNED | HAMM_FLAG_PRODUCT)) return -1;
+    if (m < 2 || m > 9) return -1;
+
+    long skip = header.magic == HAMM_MAGIC ? (long)sizeof(header) : 0;
+    byte_t* body = map + skip;
+    long body_size = size - skip;
+    long fixed;
+    if (header.flags & HAMM_FLAG_ALIGNED) fixed = correct_hamming_aligned(body, body_size / hamm_aligned_stride(m), m);
+    else if (header.flags & HAMM_FLAG_PRODUCT) fixed = correct_hamming_product(body, body_size, m);
+    else fixed = correct_hamming_array(body, body_size * 8 / ((1L << m) - 1), m);
+    if (fixed < 0) return -1;
+
+    stats->size = body_size;
+    stats->corrected = fixed;
+    stats->written = fixed;
+    return 1;
+}
+
+int hamm_scrub(const char* path, int m, hamm_scrub_stats_t* stats) {
+    str_memset(stats, 0, sizeof(*stats));
+    int fd = open(path, O_RDWR);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return 0;
+    }
+
+    long size = (long)st.st_size;
+    if (!size) {
+        close(fd);
+        return 1;
+    }
+
+    byte_t* map = (byte_t*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return 0;
+
+    /* Sequential scan, the pages behind are not needed again. */
+    madvise(map, size, MADV_SEQUENTIAL);
+    int res = _scrub_map(map, size, m, stats);
+    if (stats->written && msync(map, size, MS_SYNC)) res = 0;
+    munmap(map, size);
+    return res;
+}
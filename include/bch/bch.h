@@ -6,10 +6,15 @@ extern "C" {
 
 #include <str.h>
 
+/* Code parameters are fixed at build time, override all four together (-DBCH_M=8 -DBCH_T=8 -DBCH_K=191 -DBCH_POLY=0x11D). */
+#ifndef BCH_M
 #define BCH_M 4
 #define BCH_T 1
-#define BCH_N ((1 << BCH_M) - 1)
 #define BCH_K 11
+#define BCH_POLY 0x13
+#endif
+
+#define BCH_N ((1 << BCH_M) - 1)
 
 static inline unsigned long bch_encoded_size(unsigned long input_len) {
     return ((input_len * 8 + BCH_K - 1) / BCH_K * BCH_N + 7) / 8;
@@ -23,6 +28,26 @@ int bch_init();
 unsigned long encode_bch(const unsigned char* input, unsigned long input_len, unsigned char* output);
 unsigned long decode_bch(const unsigned char* input, unsigned long input_len, unsigned char* output);
 
+#define BCH_CHASE_MAX_P 8
+
+/*
+Chase-II soft decoding: every block with a non-zero syndrome is decoded once per
+combination of flips of its p least reliable bits, the valid codeword closest to
+the received word (smallest summed reliability of changed bits) wins. Reaches
+blocks with up to t + p errors when the extra ones sit on weak bits.
+
+Params:
+- input - Hard bits, as decode_bch takes them (MSB-first inside bytes).
+- reliability - Confidence of every coded bit (input_len * 8 bytes, 0 = coin flip, 255 = certain), see hamm_llr_split.
+- input_len - Input size.
+- output - Output location. (Size: bch_decoded_size(input_len))
+- p - Test positions per block (0..BCH_CHASE_MAX_P), 0 is plain hard decoding.
+- corrected - Optional, filled with count of bits changed.
+
+Return output size.
+*/
+unsigned long decode_bch_soft(const unsigned char* input, const unsigned char* reliability, unsigned long input_len, unsigned char* output, int p, long* corrected);
+
 #ifdef __cplusplus
 }
 #endif
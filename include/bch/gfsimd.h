@@ -0,0 +1,50 @@
+#ifndef GF_SIMD_H_
+#define GF_SIMD_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Multiply-by-constant split tables for GF(2^m).
+Multiplication by a fixed c is linear over GF(2), so a * c is the XOR of
+the products of every 4-bit nibble of a, and each nibble product is a
+16-entry table: exactly one PSHUFB/VPSHUFB per nibble.
+- gf8_tab_t  - m <= 8, a * c = lo[a & 0xF] ^ hi[a >> 4].
+- gf16_tab_t - m <= 16, nibble i of a selects lo[i] (result low byte) and hi[i] (result high byte).
+*/
+typedef struct {
+    unsigned char lo[16];
+    unsigned char hi[16];
+} gf8_tab_t;
+
+typedef struct {
+    unsigned char lo[4][16];
+    unsigned char hi[4][16];
+} gf16_tab_t;
+
+/*
+Build split tables for multiplication by c.
+
+Params:
+- t - Table to fill.
+- c - Constant.
+- alpha_to - Antilog table of the field.
+- index_of - Log table of the field (index_of[0] is unused).
+- order - Multiplicative group order (2^m - 1).
+
+Return 1.
+*/
+int gf8_tab_init(gf8_tab_t* t, int c, const int* alpha_to, const int* index_of, int order);
+int gf16_tab_init(gf16_tab_t* t, int c, const int* alpha_to, const int* index_of, int order);
+
+/*
+dst[i] = src[i] * c ^ add[i] for len elements (add may be NULL, dst may alias src or add).
+Picks AVX2, SSSE3 or the portable loop at runtime.
+*/
+void gf8_mul_region(unsigned char* dst, const unsigned char* src, const unsigned char* add, long len, const gf8_tab_t* t);
+void gf16_mul_region(unsigned short* dst, const unsigned short* src, const unsigned short* add, long len, const gf16_tab_t* t);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,90 @@
+#ifndef ECC_H_
+#define ECC_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <hamm/hamm.h>
+#include <hamm/adapt.h>
+
+#define ECC_MAX_BACKENDS 16
+
+/* Backend capabilities. */
+#define ECC_CAP_PARALLEL 0x01 /* Codes blocks on the worker pool */
+#define ECC_CAP_SIMD     0x02 /* Wide-register kernels (target_clones, gfsimd) */
+#define ECC_CAP_ANY_CODE 0x04 /* m / t picked at run time, not at build time */
+
+/*
+One implementation of a code family.
+Backends with the same format write the same bytes and are interchangeable,
+the others only read what they wrote themselves.
+- name - Unique name, used by ecc --backend.
+- codec - HAMM_CODEC_* family.
+- format - hamm_header_t flags of the files it writes (0: packed Hamming).
+- caps - ECC_CAP_* bits.
+- throughput - Rough single-thread MB/s of input, the fastest supporting backend wins.
+- supports - 1 if the (m, t) code is available.
+- encoded_size / decoded_size - Output buffer bound for an input size.
+- encode / decode - Whole-buffer coding, return output size or -1.
+*/
+typedef struct {
+    const char* name;
+    int         codec;
+    int         format;
+    int         caps;
+    double      throughput;
+    int  (*supports)(int m, int t);
+    long (*encoded_size)(long size, int m, int t);
+    long (*decoded_size)(long size, int m, int t);
+    long (*encode)(const byte_t* in, long size, byte_t* out, int m, int t);
+    long (*decode)(const byte_t* in, long size, byte_t* out, int m, int t);
+} ecc_backend_t;
+
+/*
+Add a backend to the process-wide registry (built-in ones are registered on first use).
+The descriptor is kept by pointer and must outlive the registry.
+
+Params:
+- backend - Backend descriptor.
+
+Return 1 or 0 when the name is taken or the registry is full.
+*/
+int ecc_register(const ecc_backend_t* backend);
+
+/*
+Registered backend by index, for listing.
+
+Params:
+- index - 0..count-1.
+
+Return backend or NULL past the end.
+*/
+const ecc_backend_t* ecc_backend_at(int index);
+
+/*
+Registered backend by name.
+
+Params:
+- name - Backend name.
+
+Return backend or NULL.
+*/
+const ecc_backend_t* ecc_backend(const char* name);
+
+/*
+Fastest backend (highest throughput hint) that supports the code.
+
+Params:
+- codec - HAMM_CODEC_* family.
+- format - Required file format, -1 for any.
+- m - Parity bits count / field degree.
+- t - Correctable errors per block (1 for Hamming).
+
+Return backend or NULL.
+*/
+const ecc_backend_t* ecc_pick(int codec, int format, int m, int t);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
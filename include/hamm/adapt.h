@@ -0,0 +1,68 @@
+#ifndef HAMM_ADAPT_H_
+#define HAMM_ADAPT_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HAMM_CODEC_NONE    0
+#define HAMM_CODEC_HAMMING 1
+#define HAMM_CODEC_BCH     2
+
+/* Candidate sets for hamm_select_code. */
+#define HAMM_SELECT_HAMMING 0x01 /* Hamming, m = 2..HAMM_SELECT_MAX_M */
+#define HAMM_SELECT_BCH     0x02 /* C BCH with its build-time BCH_M / BCH_T */
+#define HAMM_SELECT_BCH_ANY 0x04 /* Any binary BCH (m, t), k estimated as n - m * t */
+
+#define HAMM_SELECT_MAX_M 12
+#define HAMM_SELECT_MAX_T 64
+
+/*
+Code picked by hamm_select_code.
+- codec - HAMM_CODEC_*.
+- m - Field degree / parity bits count.
+- t - Correctable errors per block.
+- n - Block length in bits.
+- k - Data bits per block.
+- residual - Expected bit error rate after decoding.
+*/
+typedef struct {
+    int    codec;
+    int    m;
+    int    t;
+    long   n;
+    long   k;
+    double residual;
+} hamm_code_t;
+
+/*
+Analytical residual BER of a block code over a binary symmetric channel.
+A block with i > t errors is assumed to leave min(n, i + t) wrong bits
+(the decoder may add up to t more while miscorrecting).
+
+Params:
+- n - Block length in bits.
+- t - Correctable errors per block.
+- ber - Channel bit error rate.
+
+Return expected bit error rate after decoding.
+*/
+double hamm_residual_ber(long n, int t, double ber);
+
+/*
+Pick the cheapest code (lowest n / k, Hamming before BCH on ties)
+whose residual BER meets the target.
+
+Params:
+- ber - Measured or estimated channel bit error rate.
+- target - Acceptable residual bit error rate.
+- candidates - HAMM_SELECT_* mask.
+- code - Picked code (the strongest one when nothing meets the target).
+
+Return 1 if the target is met, 0 otherwise.
+*/
+int hamm_select_code(double ber, double target, int candidates, hamm_code_t* code);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
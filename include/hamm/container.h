@@ -0,0 +1,97 @@
+#ifndef HAMM_CONTAINER_H_
+#define HAMM_CONTAINER_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <hamm.h>
+#include <adapt.h>
+
+#define HAMM_CHUNK_SIZE (1 << 20)
+
+/* hamm_chunk_t flags. */
+#define HAMM_CHUNK_CRC 0x01 /* Body ends with the CRC32C of the decoded chunk */
+
+/* Upper bound of correction candidates tried on a CRC mismatch, keeps false matches below 2^-16. */
+#define HAMM_CHUNK_RECOVER_MAX (1 << 16)
+
+/* hamm_chunk_decode states. */
+#define HAMM_CHUNK_OK        0 /* CRC matches or is not stored */
+#define HAMM_CHUNK_RECOVERED 1 /* CRC mismatch fixed by the recovery search */
+#define HAMM_CHUNK_CORRUPT   2 /* CRC mismatch left, the data is damaged */
+
+/*
+Chunked stream: hamm_header_t with HAMM_FLAG_CHUNKED, then every chunk
+as hamm_chunk_t followed by enc_size encoded bytes. Each chunk carries its
+own code, so the encoder may switch codes as the channel estimate changes.
+- codec - HAMM_CODEC_*.
+- m - Parity bits count (Hamming) or field degree (BCH).
+- t - Correctable errors per block.
+- flags - HAMM_CHUNK_*.
+- size - Decoded chunk size.
+- enc_size - Encoded body size (CRC included).
+*/
+typedef struct {
+    unsigned char codec;
+    unsigned char m;
+    unsigned char t;
+    unsigned char flags;
+    unsigned int  size;
+    unsigned int  enc_size;
+} hamm_chunk_t;
+
+/*
+Encoded body size of a chunk.
+
+Params:
+- size - Decoded chunk size.
+- code - Chunk code.
+- flags - HAMM_CHUNK_* the chunk will be encoded with.
+
+Return body size or -1 if the code is not supported by the container.
+*/
+long hamm_chunk_bound(long size, const hamm_code_t* code, int flags);
+
+/*
+Output size needed by hamm_chunk_decode (may exceed chunk->size by the padding of the last block).
+-1 for an unsupported code or a header whose sizes don't match its body.
+*/
+long hamm_chunk_decoded_bound(const hamm_chunk_t* chunk);
+
+/*
+Encode one chunk.
+
+Params:
+- in - Chunk data.
+- size - Chunk data size.
+- code - Code to use (Hamming m = 2..HAMM_SELECT_MAX_M or the build-time C BCH).
+- flags - HAMM_CHUNK_CRC to store a checksum of the data.
+- chunk - Filled chunk header.
+- out - Body location. (Size: hamm_chunk_bound(size, code, flags))
+
+Return body size or -1.
+*/
+long hamm_chunk_encode(const byte_t* in, long size, const hamm_code_t* code, int flags, hamm_chunk_t* chunk, byte_t* out);
+
+/*
+Decode one chunk. With HAMM_CHUNK_CRC a checksum mismatch means some block
+was miscorrected: Hamming chunks then retry the corrected blocks with the
+other error patterns of the same syndrome, BCH chunks are only flagged.
+
+Params:
+- chunk - Chunk header.
+- body - Encoded body.
+- out - Output location. (Size: hamm_chunk_decoded_bound(chunk))
+- corrected - Optional, filled with count of bits changed by the decoder.
+              Divided by the body bits it is the channel BER estimate
+              hamm_select_code expects.
+- state - Optional, filled with HAMM_CHUNK_OK / _RECOVERED / _CORRUPT.
+
+Return chunk->size or -1.
+*/
+long hamm_chunk_decode(const hamm_chunk_t* chunk, const byte_t* body, byte_t* out, long* corrected, int* state);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
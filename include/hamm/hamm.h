@@ -12,6 +12,46 @@ extern "C" {
 
 typedef unsigned char byte_t;
 
+/* Most test positions a Chase decoder flips (2^p candidates per dirty block). */
+#define HAMM_CHASE_MAX_P 8
+
+/*
+One buffer of a batch call.
+- src - Input data.
+- len - Input data size.
+- dst - Output location (sized with calculate_encoded_size / calculate_decoded_size).
+- out_size - Filled with actual output size.
+*/
+typedef struct {
+    const byte_t* src;
+    long          len;
+    byte_t*       dst;
+    long          out_size;
+} hamm_batch_t;
+
+/*
+Header written in front of encoded files that are not in the legacy packed layout.
+- magic - HAMM_MAGIC.
+- m - Parity bits count (field degree for HAMM_FLAG_BCH).
+- flags - HAMM_FLAG_* bits.
+- reserved - Correctable errors per block for HAMM_FLAG_BCH, 0 otherwise.
+- size - Original (decoded) data size.
+*/
+#define HAMM_MAGIC        0x4D4D4148 /* "HAMM" */
+#define HAMM_FLAG_ALIGNED 0x01
+#define HAMM_FLAG_CHUNKED 0x02 /* hamm_chunk_t stream follows, see container.h */
+#define HAMM_FLAG_PRODUCT 0x04 /* n x n product code blocks, see product.h */
+#define HAMM_FLAG_BCH     0x08 /* Coding::BCH blocks written by file2bch */
+#define HAMM_FLAG_BCH_C   0x10 /* bch.h blocks (build-time BCH_M / BCH_T), see ecc.h */
+
+typedef struct {
+    unsigned int       magic;
+    unsigned char      m;
+    unsigned char      flags;
+    unsigned short     reserved;
+    unsigned long long size;
+} hamm_header_t;
+
 static inline byte_t get_bit_buff(const void* buf, long bit) {
     const byte_t* b = (const byte_t*)buf;
     return (b[bit / 8] >> (bit % 8)) & 1;
@@ -28,6 +68,39 @@ static inline void toggle_bit_buff(void* buf, long bit) {
     b[bit / 8] ^= (1 << (bit % 8));
 }
 
+/*
+Read up to 64 consecutive bits (LSB-first) starting at bit.
+Only bytes that hold requested bits are touched.
+*/
+static inline unsigned long long get_bits_buff(const void* buf, long bit, int count) {
+    const byte_t* b = (const byte_t*)buf + bit / 8;
+    int shift = bit % 8;
+    unsigned long long val = (unsigned long long)(*b++) >> shift;
+    for (int got = 8 - shift; got < count; got += 8) {
+        val |= (unsigned long long)(*b++) << got;
+    }
+
+    return count < 64 ? val & ((1ULL << count) - 1) : val;
+}
+
+/*
+Write up to 64 consecutive bits (LSB-first) starting at bit.
+Neighbour bits in partially covered bytes are preserved.
+*/
+static inline void set_bits_buff(void* buf, long bit, int count, unsigned long long val) {
+    byte_t* b = (byte_t*)buf + bit / 8;
+    int shift = bit % 8;
+    while (count > 0) {
+        int take = MIN(8 - shift, count);
+        byte_t mask = (byte_t)(((1 << take) - 1) << shift);
+        *b = (*b & ~mask) | ((byte_t)(val << shift) & mask);
+        val >>= take;
+        count -= take;
+        shift = 0;
+        b++;
+    }
+}
+
 /*
 Calculate size of encoded buffer with input decoded size and parity bits count.
 
@@ -60,6 +133,30 @@ static inline long calculate_decoded_size(long esize, int m) {
     return (blocks * k + 7) / 8;
 }
 
+/*
+Bytes taken by one codeword in the aligned layout.
+Every codeword gets padded to the next power of two bits (n + 1), so block b
+starts at byte b * stride and never shares a byte with its neighbours.
+
+Params:
+- m - Parity bits count.
+
+Return codeword stride in bytes.
+*/
+static inline long hamm_aligned_stride(int m) {
+    return m < 3 ? 1 : 1L << (m - 3);
+}
+
+static inline long calculate_encoded_size_aligned(long dsize, int m) {
+    long k = (1 << m) - 1 - m;
+    return (dsize * 8 + k - 1) / k * hamm_aligned_stride(m);
+}
+
+static inline long calculate_decoded_size_aligned(long esize, int m) {
+    long k = (1 << m) - 1 - m;
+    return (esize / hamm_aligned_stride(m) * k + 7) / 8;
+}
+
 /*
 Encode input decoded data with m-pariry bits.
 
@@ -112,6 +209,126 @@ Return actual output size.
 */
 long decode_hamming_array(const byte_t* in, long in_size, byte_t* out, int m);
 
+/*
+Per-bit reference versions of encode_hamming_array / decode_hamming_array
+(one encode_hamming / decode_hamming call per block, same output).
+The array calls fall back to them above m = 9, ecc exposes them for A/B runs.
+*/
+long encode_hamming_array_scalar(const byte_t* in, long in_size, byte_t* out, int m);
+long decode_hamming_array_scalar(const byte_t* in, long in_size, byte_t* out, int m);
+
+/*
+Split soft channel values into the hard bits and reliabilities the *_soft decoders take.
+
+Params:
+- llr - Log-likelihood ratio log(P(0) / P(1)) of every coded bit.
+- bits - Coded bits count.
+- hard - Output hard decisions, (bits + 7) / 8 bytes, LSB-first (MSB-first when msb_first, as bch.h reads them).
+- reliability - Output confidence per bit, min(255, |llr| * scale).
+- scale - Reliability units per LLR unit.
+- msb_first - Bit order of hard.
+*/
+void hamm_llr_split(const float* llr, long bits, byte_t* hard, byte_t* reliability, float scale, int msb_first);
+
+/*
+Chase-II soft decoding of a packed array. Blocks with a non-zero syndrome get
+their p least reliable bits flipped in every combination, the hard decoder
+finishes each candidate and the codeword with the smallest summed reliability
+of changed bits wins. Catches most two-error blocks the hard decoder would
+miscorrect, as long as one of the errors sits on a weak bit.
+
+Params:
+- in - Input hard bits (packed like encode_hamming_array output).
+- reliability - Confidence of every coded bit (in_size * 8 bytes, 0 = coin flip, 255 = certain).
+- in_size - Input size.
+- out - Output location. (Size: calculate_decoded_size(in_size, m))
+- m - Parity bits count (2..9).
+- p - Test positions per block (0..HAMM_CHASE_MAX_P), 0 is plain hard decoding.
+- corrected - Optional, filled with count of bits changed.
+
+Return actual output size or -1.
+*/
+long decode_hamming_soft(const byte_t* in, const byte_t* reliability, long in_size, byte_t* out, int m, int p, long* corrected);
+
+/*
+Fix single-bit errors of packed codewords in place (block b at bit b * n),
+without extracting the data. Building block of the product code (see product.h).
+
+Params:
+- buf - Codewords.
+- blocks - Codewords count.
+- m - Parity bits count (2..9).
+
+Return corrected codewords count or -1.
+*/
+long correct_hamming_array(byte_t* buf, long blocks, int m);
+
+/*
+Encode entire array into the aligned layout (see hamm_aligned_stride).
+Padding bits are written as zero and ignored by the decoder.
+
+Params:
+- in - Input decoded data.
+- in_size - Input decoded data size.
+- out - Output location. (Size: calculate_encoded_size_aligned(in_size, m))
+- m - Parity bits count (2..9).
+
+Return actual output size or -1.
+*/
+long encode_hamming_aligned(const byte_t* in, long in_size, byte_t* out, int m);
+
+/*
+Decode entire array in the aligned layout.
+
+Params:
+- in - Input source data.
+- in_size - Input source data size.
+- out - Output location. (Size: calculate_decoded_size_aligned(in_size, m))
+- m - Parity bits count (2..9).
+
+Return actual output size or -1.
+*/
+long decode_hamming_aligned(const byte_t* in, long in_size, byte_t* out, int m);
+
+/*
+Fix single-bit errors of aligned layout codewords in place (see correct_hamming_array).
+
+Params:
+- buf - Codewords (block b at byte b * hamm_aligned_stride(m)).
+- blocks - Codewords count.
+- m - Parity bits count (2..9).
+
+Return corrected codewords count or -1.
+*/
+long correct_hamming_aligned(byte_t* buf, long blocks, int m);
+
+/*
+Encode many independent buffers with the same parity bits count in one call.
+Tables are built once and the blocks of every buffer go to the pool in a
+single parallel range, so many small buffers still fill the workers.
+
+Params:
+- items - Buffer descriptors, out_size of each one is filled.
+- count - Descriptors count.
+- m - Parity bits count.
+
+Return total output size or -1.
+*/
+long encode_hamming_batch(hamm_batch_t* items, long count, int m);
+
+/*
+Decode many independent buffers with the same parity bits count in one call
+(one parallel range for the whole batch, as encode_hamming_batch).
+
+Params:
+- items - Buffer descriptors, out_size of each one is filled.
+- count - Descriptors count.
+- m - Parity bits count.
+
+Return total output size or -1.
+*/
+long decode_hamming_batch(hamm_batch_t* items, long count, int m);
+
 #ifdef __cplusplus
 }
 #endif
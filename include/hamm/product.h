@@ -0,0 +1,78 @@
+#ifndef HAMM_PRODUCT_H_
+#define HAMM_PRODUCT_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <hamm.h>
+
+#define HAMM_PRODUCT_ITERATIONS 8
+
+/*
+2D product code: k x k data bits of a block are Hamming-encoded row by row,
+then every one of the n columns is encoded again, giving an n x n bit matrix
+stored row-major (row r of block b at bit (b * n + r) * n, packed like
+encode_hamming_array output). Decoding alternates column and row passes until
+neither changes anything, which clears any three errors per block,
+bursts spread over several rows and most scratches wider than a single Hamming block can take.
+*/
+
+static inline long calculate_encoded_size_product(long dsize, int m) {
+    long n = (1 << m) - 1;
+    long k = n - m;
+    long blocks = (dsize * 8 + k * k - 1) / (k * k);
+    return (blocks * n * n + 7) / 8;
+}
+
+static inline long calculate_decoded_size_product(long esize, int m) {
+    long n = (1 << m) - 1;
+    long k = n - m;
+    long blocks = esize * 8 / (n * n);
+    return (blocks * k * k + 7) / 8;
+}
+
+/*
+Encode entire array into product code blocks.
+
+Params:
+- in - Input decoded data.
+- in_size - Input decoded data size.
+- out - Output location. (Size: calculate_encoded_size_product(in_size, m))
+- m - Parity bits count of both dimensions (2..9).
+
+Return actual output size or -1.
+*/
+long encode_hamming_product(const byte_t* in, long in_size, byte_t* out, int m);
+
+/*
+Decode product code blocks with iterative row / column correction.
+Row and column passes run on the pool.
+
+Params:
+- in - Input encoded data.
+- in_size - Input encoded data size.
+- out - Output location. (Size: calculate_decoded_size_product(in_size, m))
+- m - Parity bits count (2..9).
+- corrected - Filled with the corrected bits count, may be NULL.
+
+Return actual output size or -1.
+*/
+long decode_hamming_product(const byte_t* in, long in_size, byte_t* out, int m, long* corrected);
+
+/*
+Run the decoder's row / column passes over product code blocks in place,
+without extracting data. Only bytes holding corrected bits are written.
+
+Params:
+- buf - Encoded data.
+- size - Encoded data size.
+- m - Parity bits count (2..9).
+
+Return corrected bits count or -1.
+*/
+long correct_hamming_product(byte_t* buf, long size, int m);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,50 @@
+#ifndef HAMM_SCRUB_H_
+#define HAMM_SCRUB_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <hamm.h>
+
+/*
+Result of hamm_scrub.
+- flags - Layout found (hamm_header_t flags, 0 for packed files with or without a header).
+- m - Parity bits count used for the plain layouts.
+- size - Encoded bytes checked.
+- corrected - Codewords fixed (bits for product and chunked files).
+- written - Bytes changed in the file (exact for chunked files, the corrected count elsewhere: one byte per fixed bit at most).
+- chunks - Chunks checked (chunked files).
+- corrupt - Chunks still failing their CRC (or unreadable), left as they were.
+*/
+typedef struct {
+    int  flags;
+    int  m;
+    long size;
+    long corrected;
+    long written;
+    long chunks;
+    long corrupt;
+} hamm_scrub_stats_t;
+
+/*
+Repair an encoded image in place instead of decoding it to a copy.
+The file is mapped shared and only bytes holding corrected bits are
+stored, so the kernel writes back the dirty pages alone and write I/O
+follows the error count, not the file size.
+Packed, aligned and product files are corrected codeword by codeword.
+Chunks of chunked files are decoded (CRC recovery included) and re-encoded,
+then diffed against the body. BCH files and m outside 2..9 are not supported.
+
+Params:
+- path - Encoded file.
+- m - Parity bits count of files without a header.
+- stats - Filled with what was checked and fixed.
+
+Return 1, 0 on I/O errors or -1 for unsupported layouts.
+*/
+int hamm_scrub(const char* path, int m, hamm_scrub_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,22 @@
+#ifndef CPU_H_
+#define CPU_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+Function multiversioning for hot kernels.
+With HAMM_MULTIVERSION the compiler emits one clone per listed ISA and the
+loader picks the best one for the running CPU (ifunc), so a single binary
+stays portable while still using wide registers where available.
+*/
+#if defined(HAMM_MULTIVERSION) && defined(__GNUC__) && defined(__x86_64__) && defined(__linux__)
+    #define HAMM_KERNEL __attribute__((target_clones("arch=x86-64-v3", "arch=x86-64-v2", "default")))
+#else
+    #define HAMM_KERNEL
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+#endif
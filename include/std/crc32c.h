@@ -0,0 +1,43 @@
+#ifndef CRC32C_H_
+#define CRC32C_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRC32C_POLY 0x82F63B78 /* Castagnoli, reflected */
+
+/*
+CRC32C (iSCSI / ext4 flavour). Uses the SSE4.2 or ARMv8 CRC instructions
+when the running CPU has them, slicing-by-8 tables otherwise.
+
+Params:
+- crc - Previous result (0 for a new message), lets long messages go piece by piece.
+- data - Data.
+- size - Data size.
+
+Return updated CRC.
+*/
+unsigned int crc32c(unsigned int crc, const void* data, long size);
+
+/*
+CRC change caused by flipping one bit of a message. CRC is linear, so
+crc32c(message ^ error) == crc32c(message) ^ (xor of crc32c_bit over the error bits),
+which lets a decoder test correction candidates without rehashing the data.
+
+Params:
+- bit - Bit index, LSB-first inside bytes.
+- size - Message size.
+
+Return CRC difference.
+*/
+unsigned int crc32c_bit(long bit, long size);
+
+/*
+Name of the implementation in use ("sse4.2", "armv8" or "slicing-by-8").
+*/
+const char* crc32c_impl();
+
+#ifdef __cplusplus
+}
+#endif
+#endif
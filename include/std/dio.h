@@ -0,0 +1,82 @@
+#ifndef DIO_H_
+#define DIO_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <hbuf.h>
+
+#define DIO_ALIGN 4096      /* Offset / length / address granularity of O_DIRECT transfers */
+#define DIO_STAGE (1 << 22) /* Staging buffer for unaligned pieces */
+
+#define DIO_READ   0
+#define DIO_WRITE  1
+#define DIO_DIRECT 0x01 /* O_DIRECT: bypass the page cache */
+
+/*
+Sequential file or block device stream for the tools.
+Plain mode is a thin read(2)/write(2) wrapper. In direct mode every transfer
+goes through O_DIRECT, so encoding a partition does not evict the page cache:
+aligned requests hit the caller buffer directly, the rest goes through an aligned staging buffer.
+- fd - Descriptor.
+- direct - O_DIRECT actually in use (filesystems without support fall back to plain mode).
+- device - Block device.
+- size - Size at open time (BLKGETSIZE64 for devices).
+- failed - A write failed, dio_close reports it.
+*/
+typedef struct {
+    int           fd;
+    int           mode;
+    int           direct;
+    int           device;
+    int           eof;
+    int           failed;
+    long long     size;
+    hbuf_t        stage;
+    unsigned long pos;
+    unsigned long fill;
+} dio_file_t;
+
+/*
+Open a stream. Writing truncates regular files (devices are overwritten in place).
+
+Params:
+- f - Output stream.
+- path - File or device path.
+- mode - DIO_READ / DIO_WRITE.
+- flags - DIO_DIRECT.
+
+Return 1 or 0.
+*/
+int dio_open(dio_file_t* f, const char* path, int mode, int flags);
+
+/*
+Read up to size bytes.
+
+Return bytes read (less than size only at the end) or -1.
+*/
+long dio_read(dio_file_t* f, void* dst, long size);
+
+/*
+Write size bytes (buffered until an aligned block is complete in direct mode).
+
+Return size or -1.
+*/
+long dio_write(dio_file_t* f, const void* src, long size);
+
+/*
+Restart a read stream from the beginning.
+*/
+int dio_rewind(dio_file_t* f);
+
+/*
+Flush the tail (written without O_DIRECT, then dropped from the cache) and close.
+
+Return 1 or 0 if this or any earlier write failed.
+*/
+int dio_close(dio_file_t* f);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,64 @@
+#ifndef HBUF_H_
+#define HBUF_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HBUF_PAGE_SIZE  4096UL
+#define HBUF_HUGE_2M    (1UL << 21)
+#define HBUF_HUGE_1G    (1UL << 30)
+
+/* Request flags, tried from the largest pages down. */
+#define HBUF_HUGETLB 0x01 /* Reserved hugetlbfs pages (MAP_HUGETLB), 1 GB for buffers that fill one */
+#define HBUF_THP     0x02 /* Transparent huge pages (madvise MADV_HUGEPAGE) */
+#define HBUF_HUGE    (HBUF_HUGETLB | HBUF_THP)
+
+/* What the buffer ended up with. */
+#define HBUF_KIND_MALLOC 0
+#define HBUF_KIND_PAGES  1
+#define HBUF_KIND_THP    2
+#define HBUF_KIND_2M     3
+#define HBUF_KIND_1G     4
+
+/*
+Large I/O buffer.
+- data - Page-aligned memory, untouched (zero) until written, so pool_touch can place it.
+- size - Requested size.
+- mapped - Mapping length.
+- kind - HBUF_KIND_*.
+*/
+typedef struct {
+    void*         data;
+    unsigned long size;
+    unsigned long mapped;
+    int           kind;
+} hbuf_t;
+
+/*
+Allocate a buffer for whole-file / streaming codec calls.
+Every huge page kind silently falls back to the next one (no reserved pages,
+no THP, non-Linux build), down to plain page-aligned memory.
+
+Params:
+- buf - Output descriptor.
+- size - Buffer size.
+- flags - HBUF_* request flags, 0 = regular pages.
+
+Return 1 or 0 if out of memory.
+*/
+int hbuf_alloc(hbuf_t* buf, unsigned long size, int flags);
+
+/*
+Release a buffer from hbuf_alloc (zeroed descriptors are ignored).
+*/
+void hbuf_free(hbuf_t* buf);
+
+/*
+Short kind name for logs ("1G", "2M", "thp", "4K", "malloc").
+*/
+const char* hbuf_kind_name(int kind);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,150 @@
+#ifndef POOL_H_
+#define POOL_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define POOL_MAX_THREADS 64
+#define POOL_DEQUE_SIZE  256
+#define POOL_PAGE_SIZE   4096
+#define POOL_NUMA_SAMPLES 1024
+
+/*
+Process-wide work-stealing pool shared by every codec call.
+Each worker owns a deque: it pops from the tail, idle workers steal from
+the head of the others. Calls that submit work also run their own tasks
+instead of sleeping, so concurrent callers never add threads on top of the pool.
+*/
+
+/*
+Task body, called for [begin, end) of the submitted range.
+*/
+typedef void (*pool_fn_t)(void* ctx, long begin, long end);
+
+/*
+Detached work item, owned by the caller and untouched by the pool once fn starts.
+- fn - Called once as fn(ctx, 0, 1).
+- ctx - Passed to fn.
+*/
+typedef struct pool_item {
+    pool_fn_t         fn;
+    void*             ctx;
+    struct pool_item* next;
+} pool_item_t;
+
+/*
+Start the pool (once, later calls are ignored).
+
+Params:
+- threads - Worker count, 0 = online CPUs. 1 disables parallel execution.
+
+Return worker count.
+*/
+int pool_init(int threads);
+
+/*
+Enable NUMA placement, only before the pool starts (see topo.h).
+Workers get pinned to CPUs spread over the nodes, every range passed to
+pool_parallel_for is cut in contiguous runs of tasks per worker and idle
+workers steal on their own node first. Callers outside the pool wait instead of
+running tasks, so buffers first-touched with pool_touch are processed where they live.
+
+Params:
+- enable - 1 to enable.
+
+Return current mode.
+*/
+int pool_numa(int enable);
+
+/*
+Worker count, starts the pool with defaults if needed.
+*/
+int pool_threads();
+
+/*
+Run fn over [0, count) split in tasks and wait for all of them.
+Task bounds are multiples of align (except the last one), so tasks never
+share an output byte when align covers a byte-aligned group of blocks.
+
+Params:
+- count - Range size.
+- grain - Preferred task size (rounded up to align).
+- align - Task boundary granularity.
+- fn - Task body.
+- ctx - Task context.
+
+Return 1.
+*/
+int pool_parallel_for(long count, long grain, long align, pool_fn_t fn, void* ctx);
+
+/*
+Queue an item to run on some worker and return at once.
+Without workers (single thread pool) the item runs before the call returns.
+
+Params:
+- item - Work item, must stay valid until its fn is called.
+
+Return 1 if queued, 0 if already executed.
+*/
+int pool_submit(pool_item_t* item);
+
+/*
+First-touch a fresh (not yet written) buffer from the workers, so each page lands
+on the node of the worker whose slice of a pool_parallel_for range covers it.
+No-op outside NUMA mode.
+
+Params:
+- buf - Buffer, pages untouched so far (large malloc, mmap).
+- size - Buffer size.
+
+Return 1 if touched.
+*/
+int pool_touch(void* buf, long size);
+
+/*
+NUMA placement report.
+- nodes - Nodes count.
+- tasks - Tasks run by workers since the start (NUMA mode only).
+- remote_tasks - Tasks stolen from a worker on another node.
+- pages - Sampled pages of the buffer.
+- remote_pages - Sampled pages living on another node than the worker slice covering them.
+*/
+typedef struct {
+    int  nodes;
+    long tasks;
+    long remote_tasks;
+    long pages;
+    long remote_pages;
+} pool_numa_stats_t;
+
+/*
+Fill stats for a buffer processed with pool_parallel_for.
+
+Params:
+- buf - Buffer.
+- size - Buffer size.
+- stats - Output.
+
+Return 1 or 0 if page placement is unknown (tasks counters are filled anyway).
+*/
+int pool_numa_stats(const void* buf, long size, pool_numa_stats_t* stats);
+
+/*
+Per-thread scratch buffer, grown on demand and reused by later calls on the same thread.
+
+Params:
+- size - Required size.
+
+Return buffer or NULL.
+*/
+void* pool_scratch(unsigned long size);
+
+/*
+Stop and join the workers.
+*/
+int pool_shutdown();
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,51 @@
+#ifndef TOPO_H_
+#define TOPO_H_
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOPO_MAX_NODES 64
+#define TOPO_MAX_CPUS  1024
+
+/*
+NUMA topology read from /sys/devices/system/node (no libnuma needed).
+Machines without it (or non-Linux builds) report a single node that owns every CPU.
+*/
+
+/*
+Node count (1 without NUMA information).
+*/
+int topo_nodes();
+
+/*
+Node of a CPU, 0 if unknown.
+*/
+int topo_cpu_node(int cpu);
+
+/*
+List online CPUs ordered by node, so consecutive entries share a memory controller.
+
+Params:
+- cpus - Output array.
+- max - Array capacity.
+
+Return CPUs count.
+*/
+int topo_cpus(int* cpus, int max);
+
+/*
+Nodes currently backing some pages (move_pages query, nothing is migrated).
+
+Params:
+- pages - Page addresses.
+- count - Pages count.
+- nodes - Node of every page, negative if not faulted in yet or unknown.
+
+Return 1 or 0 if the kernel can't tell.
+*/
+int topo_pages_node(const void** pages, long count, int* nodes);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
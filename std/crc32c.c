@@ -0,0 +1,132 @@
+#include <crc32c.h>
+#include <string.h>
+#include <pthread.h>
+#if defined(__GNUC__) && defined(__x86_64__)
+    #include <nmmintrin.h>
+    #define CRC32C_SSE42
+#elif defined(__GNUC__) && defined(__aarch64__) && defined(__linux__)
+    #include <arm_acle.h>
+    #include <sys/auxv.h>
+    #ifndef HWCAP_CRC32
+        #define HWCAP_CRC32 (1 << 7)
+    #endif
+    #define CRC32C_ARMV8
+#endif
+
+typedef unsigned int (*crc32c_fn_t)(unsigned int, const unsigned char*, long);
+
+static unsigned int   _table[8][256];
+static unsigned int   _x2n[32]; /* x^(2^i) mod P */
+static crc32c_fn_t    _impl;
+static const char*    _impl_name;
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+static unsigned int _slicing8(unsigned int crc, const unsigned char* p, long size) {
+    for (; size && ((unsigned long)p & 7); size--) crc = (crc >> 8) ^ _table[0][(crc ^ *p++) & 0xff];
+    for (; size >= 8; p += 8, size -= 8) {
+        unsigned long long w;
+        memcpy(&w, p, 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        w = __builtin_bswap64(w);
+#endif
+        w ^= crc;
+        crc = _table[7][w & 0xff] ^ _table[6][(w >> 8) & 0xff] ^ _table[5][(w >> 16) & 0xff] ^ _table[4][(w >> 24) & 0xff] ^
+              _table[3][(w >> 32) & 0xff] ^ _table[2][(w >> 40) & 0xff] ^ _table[1][(w >> 48) & 0xff] ^ _table[0][w >> 56];
+    }
+
+    while (size--) crc = (crc >> 8) ^ _table[0][(crc ^ *p++) & 0xff];
+    return crc;
+}
+
+#ifdef CRC32C_SSE42
+__attribute__((target("sse4.2")))
+static unsigned int _sse42(unsigned int crc, const unsigned char* p, long size) {
+    unsigned long long c = crc;
+    for (; size && ((unsigned long)p & 7); size--) c = _mm_crc32_u8((unsigned int)c, *p++);
+    for (; size >= 8; p += 8, size -= 8) {
+        unsigned long long w;
+        memcpy(&w, p, 8);
+        c = _mm_crc32_u64(c, w);
+    }
+
+    while (size--) c = _mm_crc32_u8((unsigned int)c, *p++);
+    return (unsigned int)c;
+}
+#endif
+
+#ifdef CRC32C_ARMV8
+__attribute__((target("+crc")))
+static unsigned int _armv8(unsigned int crc, const unsigned char* p, long size) {
+    for (; size && ((unsigned long)p & 7); size--) crc = __crc32cb(crc, *p++);
+    for (; size >= 8; p += 8, size -= 8) {
+        unsigned long long w;
+        memcpy(&w, p, 8);
+        crc = __crc32cd(crc, w);
+    }
+
+    while (size--) crc = __crc32cb(crc, *p++);
+    return crc;
+}
+#endif
+
+/* a * b mod P, both in the reflected representation (x^0 is the top bit). */
+static unsigned int _multmodp(unsigned int a, unsigned int b) {
+    unsigned int p = 0;
+    for (unsigned int m = 1U << 31; m; m >>= 1) {
+        if (a & m) p ^= b;
+        b = b & 1 ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+
+    return p;
+}
+
+static void _init() {
+    for (unsigned int i = 0; i < 256; i++) {
+        unsigned int c = i;
+        for (int j = 0; j < 8; j++) c = c & 1 ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        _table[0][i] = c;
+    }
+
+    for (int k = 1; k < 8; k++) {
+        for (int i = 0; i < 256; i++) _table[k][i] = (_table[k - 1][i] >> 8) ^ _table[0][_table[k - 1][i] & 0xff];
+    }
+
+    _x2n[0] = 1U << 30;
+    for (int i = 1; i < 32; i++) _x2n[i] = _multmodp(_x2n[i - 1], _x2n[i - 1]);
+
+    _impl = _slicing8;
+    _impl_name = "slicing-by-8";
+#ifdef CRC32C_SSE42
+    if (__builtin_cpu_supports("sse4.2")) {
+        _impl = _sse42;
+        _impl_name = "sse4.2";
+    }
+#endif
+#ifdef CRC32C_ARMV8
+    if (getauxval(AT_HWCAP) & HWCAP_CRC32) {
+        _impl = _armv8;
+        _impl_name = "armv8";
+    }
+#endif
+}
+
+unsigned int crc32c(unsigned int crc, const void* data, long size) {
+    pthread_once(&_once, _init);
+    return ~_impl(~crc, (const unsigned char*)data, size);
+}
+
+unsigned int crc32c_bit(long bit, long size) {
+    pthread_once(&_once, _init);
+    unsigned int crc = _table[0][1 << (bit & 7)];
+    unsigned int shift = 1U << 31;
+    for (long zeros = size - bit / 8 - 1, k = 3; zeros > 0; zeros >>= 1, k++) {
+        if (zeros & 1) shift = _multmodp(_x2n[k & 31], shift);
+    }
+
+    return _multmodp(shift, crc);
+}
+
+const char* crc32c_impl() {
+    pthread_once(&_once, _init);
+    return _impl_name;
+}
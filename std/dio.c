@@ -0,0 +1,182 @@
+#define _GNU_SOURCE
+#include <dio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef __linux__
+    #include <sys/ioctl.h>
+    #include <linux/fs.h>
+#endif
+#ifndef O_DIRECT
+    #define O_DIRECT 0
+#endif
+
+static int _aligned(const void* ptr, long size) {
+    return !((unsigned long)ptr % DIO_ALIGN) && !(size % DIO_ALIGN);
+}
+
+static long _read_full(int fd, unsigned char* dst, long size) {
+    long got = 0;
+    while (got < size) {
+        long res = (long)read(fd, dst + got, size - got);
+        if (res < 0 && errno == EINTR) continue;
+        if (res < 0) return -1;
+        if (!res) break;
+        got += res;
+    }
+
+    return got;
+}
+
+static int _write_full(int fd, const unsigned char* src, long size) {
+    while (size > 0) {
+        long res = (long)write(fd, src, size);
+        if (res < 0 && errno == EINTR) continue;
+        if (res <= 0) return 0;
+        src += res;
+        size -= res;
+    }
+
+    return 1;
+}
+
+int dio_open(dio_file_t* f, const char* path, int mode, int flags) {
+    memset(f, 0, sizeof(dio_file_t));
+    int base = mode == DIO_WRITE ? O_WRONLY | O_CREAT : O_RDONLY;
+    int direct = (flags & DIO_DIRECT) && O_DIRECT;
+
+    struct stat st;
+    int exists = !stat(path, &st);
+    f->device = exists && S_ISBLK(st.st_mode);
+    if (mode == DIO_WRITE && !f->device) base |= O_TRUNC;
+
+    /* tmpfs and friends refuse O_DIRECT, plain I/O still does the job there. */
+    f->fd = direct ? open(path, base | O_DIRECT, 0644) : -1;
+    if (f->fd < 0) {
+        direct = 0;
+        f->fd = open(path, base, 0644);
+        if (f->fd < 0) return 0;
+    }
+
+    f->mode = mode;
+    f->direct = direct;
+    if (!fstat(f->fd, &st)) f->size = st.st_size;
+#ifdef BLKGETSIZE64
+    unsigned long long bytes;
+    if (f->device && !ioctl(f->fd, BLKGETSIZE64, &bytes)) f->size = (long long)bytes;
+#endif
+
+    if (!hbuf_alloc(&f->stage, DIO_STAGE, 0)) {
+        close(f->fd);
+        return 0;
+    }
+
+    return 1;
+}
+
+long dio_read(dio_file_t* f, void* dst, long size) {
+    unsigned char* out = (unsigned char*)dst;
+    long got = 0;
+    while (got < size) {
+        if (f->pos < f->fill) {
+            long take = (long)(f->fill - f->pos);
+            if (take > size - got) take = size - got;
+            memcpy(out + got, (unsigned char*)f->stage.data + f->pos, take);
+            f->pos += take;
+            got += take;
+            continue;
+        }
+
+        if (f->eof) break;
+
+        /*
+        Big aligned requests skip the staging copy. A short direct read only
+        happens at the end, the file offset stays aligned otherwise.
+        */
+        long rest = size - got;
+        long bulk = rest / DIO_ALIGN * DIO_ALIGN;
+        if (bulk && _aligned(out + got, bulk)) {
+            long res = _read_full(f->fd, out + got, bulk);
+            if (res < 0) return -1;
+            if (res < bulk) f->eof = 1;
+            got += res;
+            continue;
+        }
+
+        long res = _read_full(f->fd, (unsigned char*)f->stage.data, DIO_STAGE);
+        if (res < 0) return -1;
+        if (res < DIO_STAGE) f->eof = 1;
+        f->pos = 0;
+        f->fill = res;
+    }
+
+    return got;
+}
+
+long dio_write(dio_file_t* f, const void* src, long size) {
+    const unsigned char* in = (const unsigned char*)src;
+    long done = 0;
+    while (done < size) {
+        long rest = size - done;
+        long bulk = rest / DIO_ALIGN * DIO_ALIGN;
+        if (!f->fill && bulk && _aligned(in + done, bulk)) {
+            if (!_write_full(f->fd, in + done, bulk)) {
+                f->failed = 1;
+                return -1;
+            }
+
+            done += bulk;
+            continue;
+        }
+
+        long take = (long)(DIO_STAGE - f->fill);
+        if (take > rest) take = rest;
+        memcpy((unsigned char*)f->stage.data + f->fill, in + done, take);
+        f->fill += take;
+        done += take;
+        if (f->fill == DIO_STAGE) {
+            if (!_write_full(f->fd, (unsigned char*)f->stage.data, DIO_STAGE)) {
+                f->failed = 1;
+                return -1;
+            }
+
+            f->fill = 0;
+        }
+    }
+
+    return size;
+}
+
+int dio_rewind(dio_file_t* f) {
+    if (lseek(f->fd, 0, SEEK_SET) < 0) return 0;
+    f->pos = f->fill = 0;
+    f->eof = 0;
+    return 1;
+}
+
+int dio_close(dio_file_t* f) {
+    int res = !f->failed;
+    if (f->mode == DIO_WRITE && f->fill) {
+        unsigned char* stage = (unsigned char*)f->stage.data;
+        long bulk = f->fill / DIO_ALIGN * DIO_ALIGN;
+        long tail = f->fill - bulk;
+        if (bulk && !_write_full(f->fd, stage, bulk)) res = 0;
+        if (tail && f->direct) {
+            /* O_DIRECT can't write a partial block: finish through the cache and drop it right away. */
+            fcntl(f->fd, F_SETFL, fcntl(f->fd, F_GETFL) & ~O_DIRECT);
+            off_t at = lseek(f->fd, 0, SEEK_CUR);
+            if (!_write_full(f->fd, stage + bulk, tail)) res = 0;
+#ifdef POSIX_FADV_DONTNEED
+            fdatasync(f->fd);
+            posix_fadvise(f->fd, at, tail, POSIX_FADV_DONTNEED);
+#endif
+        }
+        else if (tail && !_write_full(f->fd, stage + bulk, tail)) res = 0;
+    }
+
+    if (close(f->fd)) res = 0;
+    hbuf_free(&f->stage);
+    return res;
+}
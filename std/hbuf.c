@@ -0,0 +1,99 @@
+#define _GNU_SOURCE
+#include <hbuf.h>
+#include <stdlib.h>
+#ifdef __linux__
+    #include <sys/mman.h>
+    #ifndef MAP_HUGE_SHIFT
+        #define MAP_HUGE_SHIFT 26
+    #endif
+#endif
+
+static unsigned long _round(unsigned long size, unsigned long page) {
+    return (size + page - 1) / page * page;
+}
+
+#ifdef __linux__
+static void* _map(unsigned long size, int extra) {
+    void* data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra, -1, 0);
+    return data == MAP_FAILED ? NULL : data;
+}
+
+static int _hugetlb(hbuf_t* buf, unsigned long page, int log2, int kind) {
+    unsigned long mapped = _round(buf->size, page);
+    void* data = _map(mapped, MAP_HUGETLB | (log2 << MAP_HUGE_SHIFT));
+    if (!data) return 0;
+    buf->data = data;
+    buf->mapped = mapped;
+    buf->kind = kind;
+    return 1;
+}
+#endif
+
+int hbuf_alloc(hbuf_t* buf, unsigned long size, int flags) {
+    buf->data = NULL;
+    buf->size = size;
+    buf->mapped = 0;
+    buf->kind = HBUF_KIND_MALLOC;
+    if (!size) size = 1;
+
+#ifdef __linux__
+    /* 1 GB pages only pay off (and only get reserved) for buffers that fill most of one. */
+    if (flags & HBUF_HUGETLB) {
+        if (size >= HBUF_HUGE_1G / 2 && _hugetlb(buf, HBUF_HUGE_1G, 30, HBUF_KIND_1G)) return 1;
+        if (size >= HBUF_HUGE_2M / 2 && _hugetlb(buf, HBUF_HUGE_2M, 21, HBUF_KIND_2M)) return 1;
+    }
+
+    /*
+    THP: over-map by one huge page and start at a 2 MB boundary, otherwise
+    the kernel can only back the aligned middle of the range.
+    */
+    if ((flags & HBUF_THP) && size >= HBUF_HUGE_2M) {
+        unsigned long mapped = _round(size, HBUF_HUGE_2M) + HBUF_HUGE_2M;
+        unsigned char* raw = (unsigned char*)_map(mapped, 0);
+        if (raw) {
+            unsigned char* data = (unsigned char*)_round((unsigned long)raw, HBUF_HUGE_2M);
+            unsigned long head = data - raw;
+            unsigned long body = _round(size, HBUF_HUGE_2M);
+            if (head) munmap(raw, head);
+            if (mapped - head - body) munmap(data + body, mapped - head - body);
+
+            buf->data = data;
+            buf->mapped = body;
+            buf->kind = madvise(data, body, MADV_HUGEPAGE) ? HBUF_KIND_PAGES : HBUF_KIND_THP;
+            return 1;
+        }
+    }
+
+    unsigned long mapped = _round(size, HBUF_PAGE_SIZE);
+    buf->data = _map(mapped, 0);
+    if (buf->data) {
+        buf->mapped = mapped;
+        buf->kind = HBUF_KIND_PAGES;
+        return 1;
+    }
+#endif
+
+    if (posix_memalign(&buf->data, HBUF_PAGE_SIZE, size)) buf->data = NULL;
+    return buf->data != NULL;
+}
+
+void hbuf_free(hbuf_t* buf) {
+    if (!buf->data) return;
+#ifdef __linux__
+    if (buf->kind != HBUF_KIND_MALLOC) munmap(buf->data, buf->mapped);
+    else free(buf->data);
+#else
+    free(buf->data);
+#endif
+    buf->data = NULL;
+}
+
+const char* hbuf_kind_name(int kind) {
+    switch (kind) {
+        case HBUF_KIND_1G:    return "1G";
+        case HBUF_KIND_2M:    return "2M";
+        case HBUF_KIND_THP:   return "thp";
+        case HBUF_KIND_PAGES: return "4K";
+        default:              return "malloc";
+    }
+}
@@ -1,9 +1,22 @@
 #include <mm.h>
+#include <stdatomic.h>
 
 static unsigned char _buffer[ALLOC_BUFFER_SIZE] = { 0 };
 static mm_block_t* _mm_head = (mm_block_t*)_buffer;
 
+/* One arena for the whole process, codec calls may run on several pool workers at once. */
+static atomic_flag _mm_lock = ATOMIC_FLAG_INIT;
+
+static inline void _lock() {
+    while (atomic_flag_test_and_set_explicit(&_mm_lock, memory_order_acquire));
+}
+
+static inline void _unlock() {
+    atomic_flag_clear_explicit(&_mm_lock, memory_order_release);
+}
+
 int ll_init() {
+    _lock();
     if (_mm_head->magic != MM_BLOCK_MAGIC) {
         _mm_head->magic = MM_BLOCK_MAGIC;
         _mm_head->size  = ALLOC_BUFFER_SIZE - sizeof(mm_block_t);
@@ -11,6 +24,7 @@ int ll_init() {
         _mm_head->next  = NULL;
     }
     
+    _unlock();
     return 1;
 }
 
@@ -70,11 +84,17 @@ static void* __ll_malloc(unsigned int size, unsigned int offset, int prepare_mem
 }
 
 void* ll_malloc(unsigned int size) {
-    return __ll_malloc(size, NO_OFFSET, 0);
+    _lock();
+    void* ptr = __ll_malloc(size, NO_OFFSET, 0);
+    _unlock();
+    return ptr;
 }
 
 void* ll_mallocoff(unsigned int size, unsigned int offset) {
-    return __ll_malloc(size, offset, 0);
+    _lock();
+    void* ptr = __ll_malloc(size, offset, 0);
+    _unlock();
+    return ptr;
 }
 
 int ll_free(void* ptr) {
@@ -82,12 +102,12 @@ int ll_free(void* ptr) {
         return 0;
     }
     
+    _lock();
     mm_block_t* block = (mm_block_t*)((unsigned char*)ptr - sizeof(mm_block_t));
-    if (block->magic != MM_BLOCK_MAGIC) return 0;
-    if (block->free) return 0;
-
-    block->free = 1;
-    return 1;
+    int freed = block->magic == MM_BLOCK_MAGIC && !block->free;
+    if (freed) block->free = 1;
+    _unlock();
+    return freed;
 }
 
 void* ll_realloc(void* ptr, unsigned int size) {
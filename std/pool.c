@@ -0,0 +1,394 @@
+#define _GNU_SOURCE
+#include <pool.h>
+#include <topo.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+typedef struct {
+    pool_fn_t       fn;
+    void*           ctx;
+    atomic_long     left;
+    int             done;
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+} pool_job_t;
+
+typedef struct {
+    pool_job_t* job;
+    long        begin;
+    long        end;
+} pool_task_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    pool_task_t     tasks[POOL_DEQUE_SIZE];
+    long            head;
+    long            tail;
+} pool_deque_t;
+
+static pool_deque_t    _deques[POOL_MAX_THREADS];
+static pthread_t       _workers[POOL_MAX_THREADS];
+static atomic_int      _threads = 0;
+static atomic_long     _queued = 0;
+static atomic_uint     _next = 0;
+static int             _stop = 0;
+static pthread_mutex_t _wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  _wake = PTHREAD_COND_INITIALIZER;
+static pthread_mutex_t _init_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Detached work from pool_submit: FIFO of caller-owned items, no size limit. */
+static pthread_mutex_t _inbox_lock = PTHREAD_MUTEX_INITIALIZER;
+static pool_item_t*    _inbox_head = NULL;
+static pool_item_t*    _inbox_tail = NULL;
+
+/*
+NUMA mode (pool_numa): worker i is pinned to the i-th CPU slice of the node-ordered CPU
+list, tasks of a range go in contiguous runs to the workers and steals stay on the node first.
+*/
+static int             _numa = 0;
+static int             _cpu_of[POOL_MAX_THREADS];
+static int             _node_of[POOL_MAX_THREADS];
+static atomic_long     _tasks = 0;
+static atomic_long     _remote_tasks = 0;
+
+static _Thread_local int           _self = -1;
+static _Thread_local unsigned char* _scratch = NULL;
+static _Thread_local unsigned long  _scratch_size = 0;
+
+static int _push(int d, const pool_task_t* task) {
+    pool_deque_t* q = &_deques[d];
+    pthread_mutex_lock(&q->lock);
+    int ok = q->tail - q->head < POOL_DEQUE_SIZE;
+    if (ok) q->tasks[q->tail++ % POOL_DEQUE_SIZE] = *task;
+    pthread_mutex_unlock(&q->lock);
+    if (ok) atomic_fetch_add(&_queued, 1);
+    return ok;
+}
+
+static int _pop_tail(int d, pool_task_t* task) {
+    pool_deque_t* q = &_deques[d];
+    pthread_mutex_lock(&q->lock);
+    int ok = q->tail > q->head;
+    if (ok) *task = q->tasks[--q->tail % POOL_DEQUE_SIZE];
+    pthread_mutex_unlock(&q->lock);
+    if (ok) atomic_fetch_sub(&_queued, 1);
+    return ok;
+}
+
+static int _steal_head(int d, pool_task_t* task) {
+    pool_deque_t* q = &_deques[d];
+    if (pthread_mutex_trylock(&q->lock)) return 0;
+    int ok = q->tail > q->head;
+    if (ok) *task = q->tasks[q->head++ % POOL_DEQUE_SIZE];
+    pthread_mutex_unlock(&q->lock);
+    if (ok) atomic_fetch_sub(&_queued, 1);
+    return ok;
+}
+
+/*
+Callers only pick up tasks of their own job, a small request never waits
+behind somebody else's large one. The found task is swapped with the head.
+*/
+static int _take_own(pool_job_t* job, pool_task_t* task) {
+    for (int d = 0; d < _threads; d++) {
+        pool_deque_t* q = &_deques[d];
+        pthread_mutex_lock(&q->lock);
+        for (long i = q->head; i < q->tail; i++) {
+            if (q->tasks[i % POOL_DEQUE_SIZE].job != job) continue;
+            *task = q->tasks[i % POOL_DEQUE_SIZE];
+            q->tasks[i % POOL_DEQUE_SIZE] = q->tasks[q->head % POOL_DEQUE_SIZE];
+            q->head++;
+            pthread_mutex_unlock(&q->lock);
+            atomic_fetch_sub(&_queued, 1);
+            return 1;
+        }
+
+        pthread_mutex_unlock(&q->lock);
+    }
+
+    return 0;
+}
+
+static pool_item_t* _pop_inbox() {
+    pthread_mutex_lock(&_inbox_lock);
+    pool_item_t* item = _inbox_head;
+    if (item) {
+        _inbox_head = item->next;
+        if (!_inbox_head) _inbox_tail = NULL;
+    }
+
+    pthread_mutex_unlock(&_inbox_lock);
+    if (item) atomic_fetch_sub(&_queued, 1);
+    return item;
+}
+
+static void _run(const pool_task_t* task) {
+    pool_job_t* job = task->job;
+    job->fn(job->ctx, task->begin, task->end);
+    if (atomic_fetch_sub(&job->left, 1) == 1) {
+        pthread_mutex_lock(&job->lock);
+        job->done = 1;
+        pthread_cond_signal(&job->cond);
+        pthread_mutex_unlock(&job->lock);
+    }
+}
+
+/* Same node victims first, other nodes only when the whole node is idle. */
+static int _steal(pool_task_t* task, int* victim) {
+    for (int pass = 0; pass < 1 + _numa; pass++) {
+        for (int i = 1; i < _threads; i++) {
+            int d = (_self + i) % _threads;
+            if (_numa && (_node_of[d] == _node_of[_self]) == pass) continue;
+            if (_steal_head(d, task)) {
+                *victim = d;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static void _pin(int self) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(_cpu_of[self], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+}
+
+static void* _worker(void* arg) {
+    _self = (int)(long)arg;
+    if (_numa) _pin(_self);
+
+    pool_task_t task;
+    for (;;) {
+        int victim = _self;
+        int found = _pop_tail(_self, &task) || _steal(&task, &victim);
+        if (found) {
+            if (_numa) {
+                atomic_fetch_add(&_tasks, 1);
+                if (_node_of[victim] != _node_of[_self]) atomic_fetch_add(&_remote_tasks, 1);
+            }
+
+            _run(&task);
+            continue;
+        }
+
+        pool_item_t* item = _pop_inbox();
+        if (item) {
+            item->fn(item->ctx, 0, 1);
+            continue;
+        }
+
+        pthread_mutex_lock(&_wake_lock);
+        while (!_stop && !atomic_load(&_queued)) pthread_cond_wait(&_wake, &_wake_lock);
+        int stop = _stop && !atomic_load(&_queued);
+        pthread_mutex_unlock(&_wake_lock);
+        if (stop) break;
+    }
+
+    free(_scratch);
+    _scratch = NULL;
+    return NULL;
+}
+
+int pool_init(int threads) {
+    pthread_mutex_lock(&_init_lock);
+    if (!_threads) {
+        if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        if (threads < 1) threads = 1;
+        if (threads > POOL_MAX_THREADS) threads = POOL_MAX_THREADS;
+
+        _stop = 0;
+        int cpus[TOPO_MAX_CPUS];
+        int ncpus = _numa ? topo_cpus(cpus, TOPO_MAX_CPUS) : 0;
+        for (int i = 0; i < threads; i++) {
+            pthread_mutex_init(&_deques[i].lock, NULL);
+            _deques[i].head = _deques[i].tail = 0;
+            _cpu_of[i] = ncpus ? cpus[(long)i * ncpus / threads] : i;
+            _node_of[i] = ncpus ? topo_cpu_node(_cpu_of[i]) : 0;
+        }
+
+        /*
+        A single thread pool runs everything inline, no workers needed.
+        _threads is read without the lock (pool_threads), it is published only once every
+        worker runs: nobody can push to the deque of a worker that failed to start.
+        */
+        int started = 0;
+        while (threads > 1 && started < threads && !pthread_create(&_workers[started], NULL, _worker, (void*)(long)started)) started++;
+        if (threads > 1 && started < threads) {
+            /* Nothing should be queued yet, run whatever is anyway before the workers go. */
+            pool_task_t task;
+            pool_item_t* item;
+            for (int d = 0; d < threads; d++) while (_pop_tail(d, &task)) _run(&task);
+            while ((item = _pop_inbox())) item->fn(item->ctx, 0, 1);
+
+            pthread_mutex_lock(&_wake_lock);
+            _stop = 1;
+            pthread_cond_broadcast(&_wake);
+            pthread_mutex_unlock(&_wake_lock);
+            for (int i = 0; i < started; i++) pthread_join(_workers[i], NULL);
+            threads = 1;
+        }
+
+        _threads = threads;
+    }
+
+    int res = _threads;
+    pthread_mutex_unlock(&_init_lock);
+    return res;
+}
+
+int pool_threads() {
+    return _threads ? _threads : pool_init(0);
+}
+
+int pool_parallel_for(long count, long grain, long align, pool_fn_t fn, void* ctx) {
+    if (count <= 0) return 1;
+    if (align < 1) align = 1;
+    grain = (grain + align - 1) / align * align;
+    if (grain < align) grain = align;
+
+    if (count <= grain || pool_threads() < 2) {
+        fn(ctx, 0, count);
+        return 1;
+    }
+
+    pool_job_t job = { .fn = fn, .ctx = ctx, .done = 0 };
+    long tasks = (count + grain - 1) / grain;
+    atomic_init(&job.left, tasks);
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.cond, NULL);
+
+    /*
+    Our own worker deque first when called from inside a task, round-robin otherwise.
+    In NUMA mode task i always lands on worker i * threads / tasks: the same slice of
+    every range (and of pool_touch) goes to the same node.
+    */
+    unsigned int d = _self >= 0 ? (unsigned int)_self : atomic_fetch_add(&_next, 1);
+    for (long begin = 0, i = 0; begin < count; begin += grain, i++) {
+        pool_task_t task = { .job = &job, .begin = begin, .end = begin + grain < count ? begin + grain : count };
+        int target = _numa ? (int)(i * _threads / tasks) : (int)(d++ % _threads);
+        if (!_push(target, &task)) _run(&task);
+    }
+
+    pthread_mutex_lock(&_wake_lock);
+    pthread_cond_broadcast(&_wake);
+    pthread_mutex_unlock(&_wake_lock);
+
+    /* An unpinned caller would only drag slices to whatever node it runs on. */
+    pool_task_t task;
+    if (!_numa || _self >= 0) while (_take_own(&job, &task)) _run(&task);
+
+    pthread_mutex_lock(&job.lock);
+    while (!job.done) pthread_cond_wait(&job.cond, &job.lock);
+    pthread_mutex_unlock(&job.lock);
+
+    pthread_mutex_destroy(&job.lock);
+    pthread_cond_destroy(&job.cond);
+    return 1;
+}
+
+int pool_submit(pool_item_t* item) {
+    if (pool_threads() < 2) {
+        item->fn(item->ctx, 0, 1);
+        return 0;
+    }
+
+    item->next = NULL;
+    pthread_mutex_lock(&_inbox_lock);
+    if (_inbox_tail) _inbox_tail->next = item;
+    else _inbox_head = item;
+    _inbox_tail = item;
+    pthread_mutex_unlock(&_inbox_lock);
+    atomic_fetch_add(&_queued, 1);
+
+    pthread_mutex_lock(&_wake_lock);
+    pthread_cond_signal(&_wake);
+    pthread_mutex_unlock(&_wake_lock);
+    return 1;
+}
+
+int pool_numa(int enable) {
+    pthread_mutex_lock(&_init_lock);
+    if (!_threads) _numa = enable ? 1 : 0;
+    int res = _numa;
+    pthread_mutex_unlock(&_init_lock);
+    return res;
+}
+
+static void _touch_task(void* ctx, long begin, long end) {
+    volatile unsigned char* buf = (volatile unsigned char*)((void**)ctx)[0];
+    long size = (long)((void**)ctx)[1];
+    for (long page = begin; page < end; page++) {
+        long offset = page * POOL_PAGE_SIZE;
+        buf[offset < size ? offset : size - 1] = 0;
+    }
+}
+
+int pool_touch(void* buf, long size) {
+    if (!_numa || size <= 0 || pool_threads() < 2) return 0;
+    long pages = (size + POOL_PAGE_SIZE - 1) / POOL_PAGE_SIZE;
+    void* ctx[2] = { buf, (void*)size };
+    pool_parallel_for(pages, (pages + _threads - 1) / _threads, 1, _touch_task, ctx);
+    return 1;
+}
+
+int pool_numa_stats(const void* buf, long size, pool_numa_stats_t* stats) {
+    stats->nodes = topo_nodes();
+    stats->tasks = atomic_load(&_tasks);
+    stats->remote_tasks = atomic_load(&_remote_tasks);
+    stats->pages = stats->remote_pages = 0;
+
+    int threads = pool_threads();
+    long pages = size > 0 ? (size + POOL_PAGE_SIZE - 1) / POOL_PAGE_SIZE : 0;
+    long step = pages > POOL_NUMA_SAMPLES ? pages / POOL_NUMA_SAMPLES : 1;
+    const void* addrs[POOL_NUMA_SAMPLES];
+    int owners[POOL_NUMA_SAMPLES];
+    int nodes[POOL_NUMA_SAMPLES];
+    long count = 0;
+    for (long page = 0; page < pages && count < POOL_NUMA_SAMPLES; page += step, count++) {
+        addrs[count] = (const unsigned char*)buf + page * POOL_PAGE_SIZE;
+        owners[count] = _numa ? _node_of[page * threads / pages] : 0;
+    }
+
+    if (!count || !topo_pages_node(addrs, count, nodes)) return 0;
+    for (long i = 0; i < count; i++) {
+        if (nodes[i] < 0) continue;
+        stats->pages++;
+        if (nodes[i] != owners[i]) stats->remote_pages++;
+    }
+
+    return 1;
+}
+
+void* pool_scratch(unsigned long size) {
+    if (size > _scratch_size) {
+        unsigned char* grown = (unsigned char*)realloc(_scratch, size);
+        if (!grown) return NULL;
+        _scratch = grown;
+        _scratch_size = size;
+    }
+
+    return _scratch;
+}
+
+int pool_shutdown() {
+    pthread_mutex_lock(&_init_lock);
+    if (_threads > 1) {
+        pthread_mutex_lock(&_wake_lock);
+        _stop = 1;
+        pthread_cond_broadcast(&_wake);
+        pthread_mutex_unlock(&_wake_lock);
+        for (int i = 0; i < _threads; i++) pthread_join(_workers[i], NULL);
+    }
+
+    _threads = 0;
+    pthread_mutex_unlock(&_init_lock);
+    return 1;
+}
@@ -0,0 +1,87 @@
+#define _GNU_SOURCE
+#include <topo.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+    #include <sys/syscall.h>
+#endif
+
+static int           _nodes = 1;
+static int           _ncpus = 0;
+static int           _cpus[TOPO_MAX_CPUS];
+static unsigned char _cpu_node[TOPO_MAX_CPUS];
+static pthread_once_t _once = PTHREAD_ONCE_INIT;
+
+/* cpulist format: "0-3,8,10-11". Nodes keep their kernel ids, memory-only nodes are skipped. */
+static void _read_cpulist(FILE* f, int node) {
+    int first, last;
+    char sep;
+    while (fscanf(f, "%d", &first) == 1) {
+        last = first;
+        if (fscanf(f, "%c", &sep) == 1 && sep == '-') {
+            if (fscanf(f, "%d", &last) != 1) break;
+            if (fscanf(f, "%c", &sep) != 1) sep = 0;
+        }
+
+        for (int cpu = first; cpu <= last && cpu < TOPO_MAX_CPUS && _ncpus < TOPO_MAX_CPUS; cpu++) {
+            if (cpu < 0) continue;
+            _cpu_node[cpu] = (unsigned char)node;
+            _cpus[_ncpus++] = cpu;
+        }
+
+        if (sep != ',') break;
+    }
+}
+
+static void _init() {
+#ifdef __linux__
+    int found = 0;
+    for (int node = 0; node < TOPO_MAX_NODES; node++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE* f = fopen(path, "r");
+        if (!f) continue;
+
+        int before = _ncpus;
+        _read_cpulist(f, node);
+        fclose(f);
+        if (_ncpus > before) found++;
+    }
+
+    if (found) {
+        _nodes = found;
+        return;
+    }
+#endif
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int cpu = 0; cpu < online && cpu < TOPO_MAX_CPUS; cpu++) {
+        _cpu_node[cpu] = 0;
+        _cpus[_ncpus++] = cpu;
+    }
+}
+
+int topo_nodes() {
+    pthread_once(&_once, _init);
+    return _nodes;
+}
+
+int topo_cpu_node(int cpu) {
+    pthread_once(&_once, _init);
+    return cpu >= 0 && cpu < TOPO_MAX_CPUS ? _cpu_node[cpu] : 0;
+}
+
+int topo_cpus(int* cpus, int max) {
+    pthread_once(&_once, _init);
+    int count = _ncpus < max ? _ncpus : max;
+    for (int i = 0; i < count; i++) cpus[i] = _cpus[i];
+    return count;
+}
+
+int topo_pages_node(const void** pages, long count, int* nodes) {
+#if defined(__linux__) && defined(SYS_move_pages)
+    if (syscall(SYS_move_pages, 0, (unsigned long)count, pages, NULL, nodes, 0) == 0) return 1;
+#endif
+    for (long i = 0; i < count; i++) nodes[i] = -1;
+    return 0;
+}
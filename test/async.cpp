@@ -0,0 +1,135 @@
+// Coding::AsyncOperation / AsyncContext: awaited operations complete with the bytes of a
+// blocking call, parked operations leave the queue on a stop request, and the context
+// never runs more than max_in_flight operations and drains back to 0 / 0.
+#include <Async.h>
+#include <pool.h>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check( bool ok, const char* what )
+{
+    if ( !ok ) {
+        std::fprintf( stderr, "FAIL: %s\n", what );
+        ++failures;
+    }
+}
+
+// Fire-and-forget coroutine, runs until its first suspension right away
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+enum { PENDING, DONE, CANCELLED, FAILED };
+
+struct Outcome {
+    std::atomic<int> state{ PENDING };
+    size_t size = 0;
+};
+
+// Operations can't be copied or moved, the coroutine builds its own
+Task await( std::function<Coding::AsyncOperation()> make, Outcome& outcome )
+{
+    try {
+        outcome.size = co_await make();
+        outcome.state = DONE;
+    }
+    catch ( const Coding::Cancelled& ) {
+        outcome.state = CANCELLED;
+    }
+    catch ( const std::exception& ) {
+        outcome.state = FAILED;
+    }
+}
+
+// Completion happens on the workers, poll with a generous timeout
+template <typename F>
+bool wait_for( F&& ready )
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds( 10 );
+    while ( !ready() ) {
+        if ( std::chrono::steady_clock::now() > deadline ) return false;
+        std::this_thread::yield();
+    }
+    return true;
+}
+
+void completion()
+{
+    Coding::AsyncContext context( 2 );
+    Coding::HammingCodec codec( 4, context );
+    std::vector<std::byte> plain( 1 << 20 ), cipher( codec.encoded_size( plain.size() ) ), expected( cipher.size() );
+    std::mt19937 rng( 1 );
+    for ( auto& b : plain ) b = std::byte( rng() );
+    size_t size = codec.encode( plain, expected );
+
+    Outcome outcome;
+    await( [ & ] { return codec.encode_async( plain, cipher ); }, outcome );
+    check( wait_for( [ & ] { return outcome.state != PENDING; } ), "async encode completes" );
+    check( outcome.state == DONE && outcome.size == size, "async encode size" );
+    check( cipher == expected, "async encode matches the blocking call" );
+    check( context.in_flight() == 0 && context.waiting() == 0, "context drained after completion" );
+}
+
+// One slot: a gated operation holds it, the next ones park until it is released.
+void back_pressure()
+{
+    Coding::AsyncContext context( 1 );
+    std::atomic<bool> gate( false );
+    std::atomic<int> started( 0 );
+    auto chunk = [ & ]( size_t ) -> long {
+        ++started;
+        while ( !gate ) std::this_thread::yield();
+        return 1;
+    };
+
+    Outcome holder, parked, cancelled, stopped;
+    std::stop_source stop, stop_early;
+    stop_early.request_stop();
+
+    await( [ & ] { return Coding::AsyncOperation( context, 1, chunk ); }, holder );
+    await( [ & ] { return Coding::AsyncOperation( context, 3, chunk ); }, parked );
+    await( [ & ] { return Coding::AsyncOperation( context, 1, chunk, stop.get_token() ); }, cancelled );
+    await( [ & ] { return Coding::AsyncOperation( context, 1, chunk, stop_early.get_token() ); }, stopped );
+    check( stopped.state == CANCELLED, "stop requested before the await cancels right away" );
+    check( context.in_flight() == 1 && context.waiting() == 2, "operations past max_in_flight park" );
+    check( wait_for( [ & ] { return started == 1; } ) && started == 1, "only the holder runs" );
+
+    stop.request_stop();
+    check( cancelled.state == CANCELLED, "stop request withdraws a parked operation" );
+    check( context.waiting() == 1, "cancelled operation left the queue" );
+
+    gate = true;
+    check( wait_for( [ & ] { return holder.state != PENDING && parked.state != PENDING; } ), "gated operations complete" );
+    check( holder.state == DONE && holder.size == 1, "holder result" );
+    check( parked.state == DONE && parked.size == 3, "parked operation runs once a slot frees" );
+    check( started == 4, "cancelled operations never run" );
+    check( context.in_flight() == 0 && context.waiting() == 0, "context drained after back-pressure" );
+}
+
+}
+
+int main()
+{
+    // Real workers even on a single CPU, or every chunk would run inline in the awaiting thread
+    pool_init( 4 );
+    completion();
+    back_pressure();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
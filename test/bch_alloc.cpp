@@ -0,0 +1,103 @@
+// Steady-state BCH coding and BinPolynom division must not touch the heap.
+// Global operator new is replaced by a counting one, every loop runs once to warm
+// caches (codes, pool scratch, thread-local vectors) and then again counted.
+#include <BCH.h>
+#include <BinPolynom.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+
+static std::atomic<long> allocations( 0 );
+
+void* operator new( std::size_t size )
+{
+    allocations.fetch_add( 1, std::memory_order_relaxed );
+    if ( void* p = std::malloc( size ? size : 1 ) ) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, std::size_t ) noexcept { std::free( p ); }
+
+namespace {
+
+const int ROUNDS = 16;
+
+int failures = 0;
+
+void check( bool ok, const char* what )
+{
+    if ( !ok ) {
+        std::fprintf( stderr, "FAIL: %s\n", what );
+        ++failures;
+    }
+}
+
+template <typename F>
+long counted( F&& step )
+{
+    step();
+    long before = allocations.load();
+    for ( int i = 0; i < ROUNDS; ++i ) step();
+    return allocations.load() - before;
+}
+
+Coding::BinPolynom random_polynom( std::mt19937& rng, size_t size )
+{
+    Coding::BinPolynom::coefficients_t coefs( size );
+    for ( size_t i = 0; i < size; ++i ) coefs[ i ] = rng() & 1;
+    coefs[ size - 1 ] = true;
+    return Coding::BinPolynom( std::move( coefs ) );
+}
+
+void bch_spans( size_t m, size_t t )
+{
+    Coding::BCH bch( m, 2 * t + 1 );
+    std::vector<std::byte> plain( 4096 ), cipher( bch.encoded_size( plain.size() ) ), back( bch.decoded_size( cipher.size() ) );
+    std::mt19937 rng( 1 );
+    for ( auto& b : plain ) b = std::byte( rng() );
+
+    long encode = counted( [ & ] { bch.encode( plain, cipher ); } );
+    long decode = counted( [ & ] { bch.decode( cipher, back ); } );
+    std::printf( "BCH(m=%zu, t=%zu) encode: %ld, decode: %ld allocations in %d rounds\n", m, t, encode, decode, ROUNDS );
+    check( encode == 0, "BCH::encode allocates" );
+    check( decode == 0, "BCH::decode allocates" );
+    check( std::equal( plain.begin(), plain.end(), back.begin() ), "BCH round trip" );
+}
+
+void divide()
+{
+    std::mt19937 rng( 2 );
+    Coding::BinPolynom dividend = random_polynom( rng, 1023 );
+    Coding::BinPolynom divisor = random_polynom( rng, 31 );
+    Coding::BinPolynom quotient, remainder;
+
+    long count = counted( [ & ] { dividend.divide( divisor, quotient, remainder ); } );
+    std::printf( "BinPolynom::divide: %ld allocations in %d rounds\n", count, ROUNDS );
+    check( count == 0, "BinPolynom::divide allocates" );
+    check( quotient * divisor + remainder == dividend, "BinPolynom::divide result" );
+}
+
+// rhp aliasing *this, growing past its own size.
+void addmul_self()
+{
+    std::mt19937 rng( 3 );
+    Coding::BinPolynom p = random_polynom( rng, 64 );
+    Coding::BinPolynom expected = p + ( p << 64 );
+    p.addmul_shifted( p, 64 );
+    check( p == expected, "BinPolynom::addmul_shifted with rhp == *this" );
+}
+
+}
+
+int main()
+{
+    bch_spans( 10, 3 );
+    bch_spans( 15, 3 );
+    divide();
+    addmul_self();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
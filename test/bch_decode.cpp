@@ -0,0 +1,133 @@
+// Coding::BCH decoding: up to t flipped bits per block come back exact,
+// more than t are reported with Uncorrectable, syndromes of codewords are zero.
+// The largest field (m = 32) builds a code with the right block size.
+#include <BCH.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+int failures = 0;
+
+void check( bool ok, const char* what )
+{
+    if ( !ok ) {
+        std::fprintf( stderr, "FAIL: %s\n", what );
+        ++failures;
+    }
+}
+
+// Flips errors distinct bits in every block of cipher
+void flip( const Coding::BCH& bch, std::vector<std::byte>& cipher, size_t errors, std::mt19937& rng )
+{
+    size_t blocks = cipher.size() * 8 / bch.block_size();
+    std::vector<size_t> positions( bch.block_size() );
+    for ( size_t b = 0; b < blocks; ++b ) {
+        for ( size_t i = 0; i < positions.size(); ++i ) positions[ i ] = i;
+        std::shuffle( positions.begin(), positions.end(), rng );
+        for ( size_t e = 0; e < errors; ++e ) {
+            size_t bit = b * bch.block_size() + positions[ e ];
+            cipher[ bit / 8 ] ^= std::byte( 1 << ( bit % 8 ) );
+        }
+    }
+}
+
+void correct( size_t m, size_t t )
+{
+    Coding::BCH bch( m, 2 * t + 1 );
+    std::vector<std::byte> plain( 8192 ), cipher( bch.encoded_size( plain.size() ) ), back( bch.decoded_size( cipher.size() ) );
+    std::mt19937 rng( m * 100 + t );
+    for ( auto& b : plain ) b = std::byte( rng() );
+    bch.encode( plain, cipher );
+
+    for ( size_t errors = 0; errors <= t; ++errors ) {
+        std::vector<std::byte> noisy( cipher );
+        flip( bch, noisy, errors, rng );
+        bool thrown = false;
+        try {
+            bch.decode( noisy, back );
+        }
+        catch ( const Coding::Uncorrectable& ) {
+            thrown = true;
+        }
+        std::printf( "BCH(m=%zu, t=%zu) %zu errors per block\n", m, t, errors );
+        check( !thrown, "BCH::decode gives up within t errors" );
+        check( std::equal( plain.begin(), plain.end(), back.begin() ), "BCH::decode within t errors" );
+    }
+
+    // t + 1 errors can land in another codeword's sphere, but not in every one of many blocks
+    if ( cipher.size() * 8 / bch.block_size() < 16 ) return;
+    std::vector<std::byte> noisy( cipher );
+    flip( bch, noisy, t + 1, rng );
+    size_t blocks = 0;
+    try {
+        bch.decode( noisy, back );
+    }
+    catch ( const Coding::Uncorrectable& e ) {
+        blocks = e.blocks();
+    }
+    std::printf( "BCH(m=%zu, t=%zu) %zu errors per block: %zu uncorrectable blocks\n", m, t, t + 1, blocks );
+    check( blocks > 0, "BCH::decode past t errors throws Uncorrectable" );
+}
+
+// GF(2^4) with x^4 + x + 1: alpha^4 = alpha + 1, alpha^-1 = alpha^14 = alpha^3 + 1
+static_assert( Coding::GF2m::mul_mod( 8, 2, 4, 0x13 ) == 3 );
+static_assert( Coding::GF2m::inv_mod( 2, 4, 0x13 ) == 9 );
+static_assert( Coding::GF2m::div_mod( 1, 9, 4, 0x13 ) == 2 );
+static_assert( Coding::GF2m::pow_mod( 2, 15, 4, 0x13 ) == 1 );
+
+void syndromes()
+{
+    Coding::BCH bch( 8, 7 );
+    std::vector<std::byte> plain( 64 ), cipher( bch.encoded_size( plain.size() ) );
+    std::mt19937 rng( 4 );
+    for ( auto& b : plain ) b = std::byte( rng() );
+    bch.encode( plain, cipher );
+
+    std::vector<Coding::GF2m::element_t> s( bch.syndromes_qty() );
+    bch.syndromes( cipher, bch.block_size(), s );
+    check( std::all_of( s.begin(), s.end(), []( auto v ) { return v == 0; } ), "BCH::syndromes of a codeword" );
+
+    // a single error at bit i has S_j = alpha^(ij)
+    size_t bit = bch.block_size() + 5;
+    cipher[ bit / 8 ] ^= std::byte( 1 << ( bit % 8 ) );
+    bch.syndromes( cipher, bch.block_size(), s );
+    for ( size_t j = 0; j < s.size(); ++j ) check( s[ j ] == bch.field().alpha( 5 * ( j + 1 ) ), "BCH::syndromes of one error" );
+}
+
+
+// 2^32 - 1 bit blocks: the block size must not wrap, only the code is built (blocks would take 512 MB)
+void largest_field()
+{
+    Coding::BCH bch( 32, 3 );
+    std::printf( "BCH(m=32, t=1) n=%zu, k=%zu\n", bch.block_size(), bch.information_symbols() );
+    check( bch.block_size() == 0xFFFFFFFFu, "BCH(32) block size" );
+    check( bch.information_symbols() == 0xFFFFFFFFu - 32, "BCH(32) information symbols" );
+    check( Coding::BCH::parity_bits( 32, 3 ) == 32, "BCH::parity_bits( 32 )" );
+
+    bool thrown = false;
+    try {
+        Coding::BCH too_large( 33, 3 );
+    }
+    catch ( const std::invalid_argument& ) {
+        thrown = true;
+    }
+    check( thrown, "BCH(33) is rejected" );
+}
+
+}
+
+int main()
+{
+    correct( 5, 2 );
+    correct( 10, 8 );
+    correct( 15, 3 );
+    correct( 17, 2 );
+    syndromes();
+    largest_field();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,230 @@
+import os
+import json
+import time
+import random
+import platform
+import statistics
+import subprocess
+
+from dataclasses import dataclass
+
+BENCH_OPS: tuple[str, ...] = ("encode", "decode")
+CI_RESAMPLES: int = 1000
+CI_LEVEL: float = .95
+
+@dataclass
+class BenchConfig:
+    codec: str
+    m: int
+    t: int
+    size: int
+    backend: str
+
+    def key(self, op: str) -> str:
+        return f"{self.codec}/m={self.m}/t={self.t}/size={self.size}/{self.backend}/{op}"
+
+def parse_codes(codes: str) -> list[tuple[str, int, int]]:
+    """Parse --bench-codes
+
+    Args:
+        codes (str): Comma separated codec:m[:t] list, e.g. "hamming:4,bch:15:3"
+    """
+    parsed: list[tuple[str, int, int]] = []
+    for code in filter(None, codes.split(",")):
+        parts = code.split(":")
+        if parts[0] not in ("hamming", "bch") or len(parts) not in (2, 3):
+            raise ValueError(f"bad code {code}, expected hamming:m or bch:m:t")
+
+        parsed.append((parts[0], int(parts[1]), int(parts[2]) if len(parts) == 3 else 1))
+
+    return parsed
+
+def list_backends(tool: str) -> dict[str, str]:
+    """Registered backends of the ecc tool
+
+    Args:
+        tool (str): ecc binary path
+
+    Returns:
+        dict[str, str]: backend name -> codec name
+    """
+    out = subprocess.run([tool, "list"], capture_output=True, text=True, check=True).stdout
+    backends: dict[str, str] = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 2:
+            backends[parts[0]] = parts[1]
+
+    return backends
+
+def supports(tool: str, cfg: BenchConfig) -> bool:
+    """Whether the backend codes (m, t), from ecc supports (exit 0 / 1)"""
+    args = [tool, "supports", "--code", cfg.codec, "--m", str(cfg.m), "--t", str(cfg.t), "--backend", cfg.backend]
+    return subprocess.run(args, capture_output=True, text=True).returncode == 0
+
+def _run_ecc(tool: str, op: str, cfg: BenchConfig, target: str, out: str) -> float:
+    """One ecc run, seconds spent in the kernel (file I/O left out)"""
+    args = [tool, op, "--code", cfg.codec, "--m", str(cfg.m), "--t", str(cfg.t), "--backend", cfg.backend, "--target", target, "--out", out]
+    start = time.perf_counter()
+    res = subprocess.run(args, capture_output=True, text=True)
+    elapsed = time.perf_counter() - start
+    if res.returncode != 0:
+        raise RuntimeError(f"{cfg.key(op)}: ecc exited with {res.returncode}: {res.stderr.strip()}")
+
+    # [ecc] backend=hamm, in=1024, out=2048, 123.4 MB/s
+    for line in res.stdout.splitlines():
+        if line.startswith("[ecc] backend=") and line.endswith("MB/s"):
+            fields = dict(f.split("=", 1) for f in line[len("[ecc] "):].split(", ")[:3])
+            mbps = float(line.split(", ")[-1].split()[0])
+            if mbps > 0:
+                return int(fields["in"]) / 1e6 / mbps
+
+    return elapsed
+
+def _percentile(samples: list[float], q: float) -> float:
+    ordered = sorted(samples)
+    pos = (len(ordered) - 1) * q
+    low = int(pos)
+    high = min(low + 1, len(ordered) - 1)
+    return ordered[low] + (ordered[high] - ordered[low]) * (pos - low)
+
+def summarize(samples: list[float], seed: int) -> dict:
+    """Median, p95 and bootstrap confidence interval of the median
+
+    Args:
+        samples (list[float]): Throughput samples in MB/s
+        seed (int): Resampling seed, fixed so reruns give the same interval
+
+    Returns:
+        dict: median, p95 (throughput of the slowest 5%, i.e. p95 latency), ci [low, high] and samples
+    """
+    rng = random.Random(seed)
+    medians = sorted(
+        statistics.median(rng.choices(samples, k=len(samples))) for _ in range(CI_RESAMPLES)
+    )
+
+    tail = (1 - CI_LEVEL) / 2
+    return {
+        "median": statistics.median(samples),
+        "p95": _percentile(samples, .05),
+        "ci": [_percentile(medians, tail), _percentile(medians, 1 - tail)],
+        "samples": samples
+    }
+
+def measure(tool: str, cfg: BenchConfig, warmup: int, repeat: int, workdir: str, seed: int) -> dict[str, dict]:
+    """Bench encode and decode of one configuration
+
+    Args:
+        tool (str): ecc binary path
+        cfg (BenchConfig): Configuration
+        warmup (int): Untimed runs before sampling (page cache, CPU clocks, code tables)
+        repeat (int): Timed runs
+        workdir (str): Directory for the input and coded files
+        seed (int): Input data and resampling seed
+
+    Returns:
+        dict[str, dict]: key -> summary
+
+    Raises:
+        RuntimeError: ecc failed or the decoded file differs from the source
+    """
+    src = os.path.join(workdir, "bench.img")
+    enc = os.path.join(workdir, "bench.ecc")
+    dec = os.path.join(workdir, "bench.dec")
+    with open(src, "wb") as f:
+        f.write(random.Random(seed).randbytes(cfg.size))
+
+    results: dict[str, dict] = {}
+    timings: dict[str, list[float]] = { op: [] for op in BENCH_OPS }
+    for i in range(warmup + repeat):
+        for op in BENCH_OPS:
+            seconds = _run_ecc(tool, op, cfg, src if op == "encode" else enc, enc if op == "encode" else dec)
+            if i >= warmup:
+                timings[op].append(seconds)
+
+    with open(src, "rb") as f1, open(dec, "rb") as f2:
+        if f1.read() != f2.read():
+            raise RuntimeError(f"{cfg.key('decode')}: decoded file differs from the source")
+
+    for op in BENCH_OPS:
+        samples = [cfg.size / 1e6 / max(s, 1e-9) for s in timings[op]]
+        results[cfg.key(op)] = summarize(samples, seed)
+
+    return results
+
+def compare(baseline: dict, results: dict[str, dict], requested: set[str], threshold: float) -> list[str]:
+    """Configurations slower than the baseline
+
+    A configuration regresses when its median dropped by more than threshold
+    and the upper end of its confidence interval is below the baseline median
+    as well, so a noisy run alone does not fail the gate.
+
+    Requested baseline entries the run did not produce are regressions too,
+    a backend that stopped supporting a code must not drop out of the gate.
+
+    Args:
+        baseline (dict): Loaded baseline file
+        results (dict[str, dict]): This run
+        requested (set[str]): Keys of every configuration asked for, supported or not
+        threshold (float): Allowed median drop, 0.05 for 5%
+
+    Returns:
+        list[str]: Regression descriptions
+    """
+    regressions: list[str] = [
+        f"{key}: in the baseline but not measured" for key in baseline.get("results", {}) if key in requested and key not in results
+    ]
+
+    for key, res in results.items():
+        base = baseline.get("results", {}).get(key)
+        if not base:
+            continue
+
+        limit = base["median"] * (1 - threshold)
+        if res["median"] < limit and res["ci"][1] < base["median"]:
+            drop = (1 - res["median"] / base["median"]) * 100
+            regressions.append(f"{key}: {res['median']:.1f} MB/s vs {base['median']:.1f} MB/s baseline (-{drop:.1f}%)")
+
+    return regressions
+
+def host_info() -> dict:
+    return {
+        "machine": platform.machine(),
+        "processor": platform.processor(),
+        "system": platform.platform(),
+        "cpus": os.cpu_count()
+    }
+
+def host_mismatch(baseline: dict) -> list[str]:
+    """Host fields that differ from the baseline's, numbers only compare on the same machine"""
+    host = host_info()
+    recorded = baseline.get("host", {})
+    return [f"{field}: {recorded.get(field)} vs {value}" for field, value in host.items() if recorded.get(field) != value]
+
+def load_baseline(path: str) -> dict:
+    with open(path, "r") as f:
+        return json.load(f)
+
+def save_baseline(path: str, results: dict[str, dict], warmup: int, repeat: int) -> None:
+    """Write results with the host they were measured on"""
+    data = {
+        "host": host_info(),
+        "warmup": warmup,
+        "repeat": repeat,
+        "results": results
+    }
+
+    with open(path, "w") as f:
+        json.dump(data, f, indent=2, sort_keys=True)
+
+def print_results(results: dict[str, dict], baseline: dict | None) -> None:
+    print("=" * 120)
+    print(f"{'Configuration':<52} | {'Median MB/s':>11} | {'p95 MB/s':>9} | {'95% CI':>19} | {'Baseline':>9} | {'Change':>7}")
+    print("-" * 120)
+    for key, res in results.items():
+        base = (baseline or {}).get("results", {}).get(key)
+        ci = f"{res['ci'][0]:.1f}..{res['ci'][1]:.1f}"
+        base_str = f"{base['median']:.1f}" if base else "-"
+        change = f"{(res['median'] / base['median'] - 1) * 100:+.1f}%" if base and base["median"] > 0 else "-"
+        print(f"{key:<52} | {res['median']:>11.1f} | {res['p95']:>9.1f} | {ci:>19} | {base_str:>9} | {change:>7}")
+    print("=" * 120)
@@ -16,6 +16,20 @@ from unix import (
     get_cpu_temp
 )
 
+from bench import (
+    BENCH_OPS,
+    BenchConfig,
+    parse_codes,
+    list_backends,
+    supports,
+    measure,
+    compare,
+    host_mismatch,
+    load_baseline,
+    save_baseline,
+    print_results
+)
+
 from tools.injector import (
     random_bitflips, 
     white_noise_bitflips,
@@ -152,6 +166,80 @@ def _print_welcome(parser: argparse.ArgumentParser) -> None:
     else:
         print(textwrap.indent(help_text, "    "))
 
+def _run_bench(args: argparse.Namespace) -> int:
+    """Benchmark every backend of the ecc tool on every code and size, compare with a baseline
+
+    Returns:
+        int: Exit code, 1 if a configuration regressed, failed or the baseline cannot be read
+    """
+    if args.builder:
+        print(f"[BUILD] Running 'make' in {args.builder}")
+        subprocess.run(["make"], cwd=args.builder, check=True)
+
+    baseline = None
+    if args.baseline and not args.save_baseline:
+        try:
+            baseline = load_baseline(args.baseline)
+        except (OSError, ValueError) as e:
+            print(f"[BENCH] cannot load baseline {args.baseline}: {e}")
+            return 1
+
+        for mismatch in host_mismatch(baseline):
+            print(f"[WARNING] baseline host differs, {mismatch}")
+
+    backends = list_backends(args.bench_tool)
+    selected = args.bench_backends.split(",") if args.bench_backends else None
+    if selected:
+        backends = { name: codec for name, codec in backends.items() if name in selected }
+
+    workdir = os.path.dirname(os.path.abspath(args.src_file))
+    requested: set[str] = set()
+    results: dict[str, dict] = {}
+    failures: list[str] = []
+    for codec, m, t in parse_codes(args.bench_codes):
+        for size in map(int, args.bench_sizes.split(",")):
+            # A baseline backend gone from ecc list is still asked for, its keys must show up as missing
+            for key in (baseline or {}).get("results", {}):
+                prefix, backend = key.rsplit("/", 2)[:2]
+                if prefix == f"{codec}/m={m}/t={t}/size={size}" and (not selected or backend in selected):
+                    requested.add(key)
+
+            for backend in (name for name, backend_codec in backends.items() if backend_codec == codec):
+                cfg = BenchConfig(codec=codec, m=m, t=t, size=size, backend=backend)
+                requested.update(cfg.key(op) for op in BENCH_OPS)
+                if not supports(args.bench_tool, cfg):
+                    print(f"[BENCH] {backend} does not support {codec} m={m}, t={t}, skipped")
+                    continue
+
+                print(f"[BENCH] {cfg.key('*')}, warmup={args.warmup}, repeat={args.repeat}")
+                try:
+                    results.update(measure(args.bench_tool, cfg, args.warmup, args.repeat, workdir, args.seed))
+                except RuntimeError as e:
+                    failures.append(str(e))
+
+    print_results(results=results, baseline=baseline)
+    for failure in failures:
+        print(f"[FAILED] {failure}")
+
+    if args.save_baseline:
+        if failures:
+            print(f"[BENCH] baseline not saved, {len(failures)} configurations failed")
+            return 1
+
+        save_baseline(args.save_baseline, results, args.warmup, args.repeat)
+        print(f"[BENCH] baseline saved to {args.save_baseline}")
+        return 0
+
+    for key in (baseline or {}).get("results", {}):
+        if key not in requested:
+            print(f"[BENCH] {key} is in the baseline but was not requested")
+
+    regressions = compare(baseline, results, requested, args.threshold) if baseline else []
+    for regression in regressions:
+        print(f"[REGRESSION] {regression}")
+
+    return 1 if regressions or failures else 0
+
 if __name__ == "__main__":
     ascii_banner = pyfiglet.figlet_format("Hamming codes!")
     print(ascii_banner)
@@ -164,7 +252,7 @@ if __name__ == "__main__":
     parser.add_argument("--decoder", type=str, default="tools/hamm2file", help="Decoder .c file")
     parser.add_argument("--builder", type=str, help="Path to Makefile that builds coder and decoder")
     parser.add_argument("--file-gen", type=str, default="tools/gen_file", help="Generator .c file")
-    parser.add_argument("--repeat", type=int, default=1, help="Repeat count")
+    parser.add_argument("--repeat", type=int, help="Repeat count (default 1, 10 with --bench)")
     
     # === Coder and Decoder setup ===
     parser.add_argument("--file-size", type=str, default="512", help="Source file (with data) size")
@@ -181,6 +269,18 @@ if __name__ == "__main__":
     parser.add_argument("--width", type=int, default=1)
     parser.add_argument("--intensity", type=float, default=.7)
     parser.add_argument("--flips-size", type=int, default=10)
+
+    # === Benchmark ===
+    parser.add_argument("--bench", action="store_true", help="Benchmark the ecc tool instead of the coder / decoder pair")
+    parser.add_argument("--bench-tool", type=str, default="../ecc/ecc", help="ecc binary")
+    parser.add_argument("--bench-codes", type=str, default="hamming:4,hamming:8,bch:4:1,bch:15:3", help="codec:m[:t] list")
+    parser.add_argument("--bench-sizes", type=str, default="65536,1048576", help="Input sizes (bytes)")
+    parser.add_argument("--bench-backends", type=str, help="Backend list, all registered ones otherwise")
+    parser.add_argument("--warmup", type=int, default=2, help="Untimed runs before sampling")
+    parser.add_argument("--seed", type=int, default=0, help="Input data and CI resampling seed")
+    parser.add_argument("--baseline", type=str, help="Baseline JSON to compare with")
+    parser.add_argument("--save-baseline", type=str, help="Write results as a new baseline JSON")
+    parser.add_argument("--threshold", type=float, default=.05, help="Allowed median throughput drop (0.05 = 5%%)")
     args = parser.parse_args()
 
     if len(sys.argv) == 1:
@@ -190,13 +290,17 @@ if __name__ == "__main__":
         _print_parity_info()
         exit(1)
 
+    if args.bench:
+        args.repeat = args.repeat or 10
+        sys.exit(_run_bench(args=args))
+
     _build_tools(gcc=args.gcc, gener=args.file_gen, makefile_dir=args.builder)
     
     diff = enctime = dectime = cpu_enc = cpu_dec = energy_enc = energy_dec = 0.0
     ticks_enc = ticks_dec = 0
     temp_enc = temp_dec = 0.0
     
-    repeats = args.repeat
+    repeats = args.repeat or 1
     for _ in range(repeats):
         _launch_tool(tool=args.file_gen, args=["--fs", args.file_size, "--out", args.src_file])
         